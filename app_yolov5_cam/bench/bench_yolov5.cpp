@@ -0,0 +1,316 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : bench_yolov5.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for Ultralytics Detection YOLOv5 with MIPI/USB Camera
+*                Offline benchmark of CPU post-processing with the recorded DRP-AI outputs.
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include "define.h"
+#include "post_proc.h"
+#include "tensor_record.h"
+
+using namespace std;
+
+/*****************************************
+* Macro
+******************************************/
+/* Stages of the post-processing */
+#define BENCH_NUM_STAGE             (4)
+/* Tolerance of the golden detection check */
+#define GOLDEN_TH_BOX               (1.0f)
+#define GOLDEN_TH_PROB              (0.001f)
+
+const static char* stage_name[BENCH_NUM_STAGE] = { "set_outputs", "decode", "nms_proc", "total" };
+
+/*****************************************
+* Global Variables
+******************************************/
+/* Number of heap allocations (operator new) */
+static atomic<uint64_t> num_alloc (0);
+
+void* operator new(size_t size)
+{
+    num_alloc++;
+    void* p = malloc(size ? size : 1);
+    if (NULL == p)
+    {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+/*****************************************
+* Function Name : percentile
+* Description   : Get the percentile of the sorted samples.
+* Arguments     : samples = sorted samples
+*                 p = percentile [0-100]
+* Return value  : sample at the percentile
+******************************************/
+static double percentile(const vector<double>& samples, double p)
+{
+    size_t i = (size_t)(p / 100.0 * (samples.size() - 1) + 0.5);
+    return samples[min(i, samples.size() - 1)];
+}
+
+/*****************************************
+* Function Name : write_golden
+* Description   : Write the detections of all frames to the golden file.
+* Arguments     : path = path of the golden file
+*                 result = detections of each frame
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+static int8_t write_golden(const string& path, const vector<vector<detection>>& result)
+{
+    FILE* fp = fopen(path.c_str(), "w");
+    if (NULL == fp)
+    {
+        fprintf(stderr, "[ERROR] Failed to open the golden file : %s\n", path.c_str());
+        return -1;
+    }
+    for (size_t f = 0; f < result.size(); f++)
+    {
+        fprintf(fp, "frame %zu %zu\n", f, result[f].size());
+        for (const detection& d : result[f])
+        {
+            fprintf(fp, "%d %.6f %.3f %.3f %.3f %.3f\n", d.c, d.prob, d.bbox.x, d.bbox.y, d.bbox.w, d.bbox.h);
+        }
+    }
+    fclose(fp);
+    return 0;
+}
+
+/*****************************************
+* Function Name : check_golden
+* Description   : Compare the detections of all frames with the golden file.
+* Arguments     : path = path of the golden file
+*                 result = detections of each frame
+* Return value  : number of the mismatched frames
+*                 -1 if the golden file cannot be read
+******************************************/
+static int32_t check_golden(const string& path, const vector<vector<detection>>& result)
+{
+    int32_t num_mismatch = 0;
+    size_t frame = 0;
+    size_t num_det = 0;
+    detection g;
+    FILE* fp = fopen(path.c_str(), "r");
+    if (NULL == fp)
+    {
+        fprintf(stderr, "[ERROR] Failed to open the golden file : %s\n", path.c_str());
+        return -1;
+    }
+    for (size_t f = 0; f < result.size(); f++)
+    {
+        bool match = true;
+        if ((2 != fscanf(fp, " frame %zu %zu", &frame, &num_det)) || (f != frame))
+        {
+            fprintf(stderr, "[ERROR] Golden file has no frame %zu\n", f);
+            fclose(fp);
+            return -1;
+        }
+        if (num_det != result[f].size())
+        {
+            match = false;
+        }
+        for (size_t i = 0; i < num_det; i++)
+        {
+            if (6 != fscanf(fp, " %d %f %f %f %f %f", &g.c, &g.prob, &g.bbox.x, &g.bbox.y, &g.bbox.w, &g.bbox.h))
+            {
+                fprintf(stderr, "[ERROR] Invalid golden file at frame %zu\n", f);
+                fclose(fp);
+                return -1;
+            }
+            if (i >= result[f].size())
+            {
+                continue;
+            }
+            const detection& d = result[f][i];
+            if ((d.c != g.c) || (fabsf(d.prob - g.prob) > GOLDEN_TH_PROB)
+                || (fabsf(d.bbox.x - g.bbox.x) > GOLDEN_TH_BOX) || (fabsf(d.bbox.y - g.bbox.y) > GOLDEN_TH_BOX)
+                || (fabsf(d.bbox.w - g.bbox.w) > GOLDEN_TH_BOX) || (fabsf(d.bbox.h - g.bbox.h) > GOLDEN_TH_BOX))
+            {
+                match = false;
+            }
+        }
+        if (!match)
+        {
+            fprintf(stderr, "[MISMATCH] frame %zu : %zu detections (golden %zu)\n", f, result[f].size(), num_det);
+            num_mismatch++;
+        }
+    }
+    fclose(fp);
+    return num_mismatch;
+}
+
+/*****************************************
+* Function Name : usage
+* Description   : Print the usage of the benchmark.
+* Arguments     : name = program name
+* Return value  : -
+******************************************/
+static void usage(const char* name)
+{
+    printf("Usage: %s <tensor record> [-n iterations] [-g golden file] [-w golden file to write]\n", name);
+}
+
+/*****************************************
+* Function Name : main
+* Description   : Run the CPU post-processing chain on all frames of the tensor record
+*                 N times and print the latency of each stage and heap allocations per frame.
+* Arguments     : argc = number of arguments
+*                 argv[1] = tensor record file
+*                 -n = number of iterations over the record (default 100)
+*                 -g = golden file to be compared with the result
+*                 -w = golden file to be written with the result
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int32_t main(int32_t argc, char* argv[])
+{
+    int32_t num_iter = 100;
+    string record_path;
+    string golden_path;
+    string write_path;
+    TensorRecordReader reader;
+    PostProc post_proc;
+    vector<std::tuple<InOutDataType, void*, int64_t>> outputs;
+    vector<detection> det_buff;
+    vector<vector<detection>> result;
+    vector<double> samples[BENCH_NUM_STAGE];
+    chrono::steady_clock::time_point t[BENCH_NUM_STAGE];
+    uint64_t alloc_start = 0;
+    uint64_t alloc_total = 0;
+    uint64_t num_frame = 0;
+    int32_t ret = 0;
+
+    for (int32_t i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (("-n" == arg) && (i + 1 < argc))
+        {
+            num_iter = max(atoi(argv[++i]), 1);
+        }
+        else if (("-g" == arg) && (i + 1 < argc))
+        {
+            golden_path = argv[++i];
+        }
+        else if (("-w" == arg) && (i + 1 < argc))
+        {
+            write_path = argv[++i];
+        }
+        else if (record_path.empty() && ('-' != arg[0]))
+        {
+            record_path = arg;
+        }
+        else
+        {
+            usage(argv[0]);
+            return -1;
+        }
+    }
+    if (record_path.empty())
+    {
+        usage(argv[0]);
+        return -1;
+    }
+
+    if (0 != reader.open(record_path))
+    {
+        return -1;
+    }
+    num_frame = reader.get_num_frame();
+    if (0 == num_frame)
+    {
+        fprintf(stderr, "[ERROR] No frame in the tensor record.\n");
+        return -1;
+    }
+    outputs.resize(reader.get_num_output());
+    result.resize(num_frame);
+    for (int32_t s = 0; s < BENCH_NUM_STAGE; s++)
+    {
+        samples[s].reserve(num_iter * num_frame);
+    }
+    printf("Record : %s (%lu frames, %u outputs)\n", record_path.c_str(), (unsigned long)num_frame, reader.get_num_output());
+
+    for (int32_t iter = 0; iter < num_iter; iter++)
+    {
+        for (uint64_t f = 0; f < num_frame; f++)
+        {
+            reader.get_outputs(f, outputs.data());
+
+            alloc_start = num_alloc.load();
+            t[0] = chrono::steady_clock::now();
+            if (0 != post_proc.set_outputs(outputs.data(), outputs.size()))
+            {
+                return -1;
+            }
+            t[1] = chrono::steady_clock::now();
+            post_proc.decode(det_buff);
+            t[2] = chrono::steady_clock::now();
+            post_proc.nms_proc(det_buff);
+            t[3] = chrono::steady_clock::now();
+            alloc_total += num_alloc.load() - alloc_start;
+
+            for (int32_t s = 0; s < BENCH_NUM_STAGE - 1; s++)
+            {
+                samples[s].push_back(chrono::duration<double, milli>(t[s + 1] - t[s]).count());
+            }
+            samples[BENCH_NUM_STAGE - 1].push_back(chrono::duration<double, milli>(t[BENCH_NUM_STAGE - 1] - t[0]).count());
+            if (0 == iter)
+            {
+                result[f] = det_buff;
+            }
+        }
+    }
+
+    printf("%-12s %10s %10s %10s [ms]\n", "Stage", "min", "median", "p99");
+    for (int32_t s = 0; s < BENCH_NUM_STAGE; s++)
+    {
+        sort(samples[s].begin(), samples[s].end());
+        printf("%-12s %10.3f %10.3f %10.3f\n", stage_name[s], samples[s].front(), percentile(samples[s], 50), percentile(samples[s], 99));
+    }
+    printf("Allocations per frame : %.2f\n", (double)alloc_total / (double)(num_iter * num_frame));
+
+    if (!write_path.empty())
+    {
+        ret = write_golden(write_path, result);
+        if (0 == ret)
+        {
+            printf("Golden written : %s\n", write_path.c_str());
+        }
+    }
+    if (!golden_path.empty())
+    {
+        ret = check_golden(golden_path, result);
+        if (0 == ret)
+        {
+            printf("Golden check : OK\n");
+        }
+        else if (0 < ret)
+        {
+            printf("Golden check : NG (%d frames mismatched)\n", ret);
+        }
+    }
+    return (0 == ret) ? 0 : 1;
+}
@@ -0,0 +1,415 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : capture_share_test.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for Ultralytics YOLOV5 with MIPI/USB Camera
+*                Host test of the zero-copy capture buffer handover (CAPTURE_ZERO_COPY_MODE)
+*                with a fake camera and a fake pre-processing.
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include <string>
+#include <thread>
+#include "define.h"
+#include "event.h"
+#include "frame_ring.h"
+#include "capture_share.h"
+
+using namespace std;
+
+/*****************************************
+* Macro
+******************************************/
+/* Buffers of the fake camera */
+#define FAKE_CAP_BUF_NUM            (4)
+#define FAKE_CAP_BUF_SIZE           (CAM_IMAGE_SIZE)
+/* Fake physical address of the first capture buffer. The buffers follow it.
+   It is above 4 GB so that an address truncated to 32 bits is detected. */
+#define FAKE_CAP_BUF_ADDR           (0x240000000ULL)
+/* Written to a buffer when it is requeued, as the camera overwrites it with a later frame */
+#define FAKE_POISON                 (0xEE)
+/* Time of each stage (us) */
+#define FAKE_CAPTURE_INTERVAL       (300)
+#define FAKE_PRE_TIME               (200)
+#define FAKE_RUN_TIME               (1000)
+#define FAKE_CONVERT_TIME           (200)
+/* Bytes checked in a frame besides the frame ID at the top */
+#define CHECK_POINT_NUM             (8)
+
+/* State of a buffer of the fake camera */
+#define FAKE_BUF_QUEUED             (0)
+#define FAKE_BUF_DEQUEUED           (1)
+
+/* Fake V4L2 camera with the same interface as Camera.
+   A frame is the frame ID (1, 2, ...) at the top followed by the lower byte of the frame ID.
+   The buffers are dequeued in order, one at a time as the application does. */
+class FakeCamera
+{
+    public:
+        FakeCamera()
+        {
+            int32_t i;
+
+            for (i = 0; i < FAKE_CAP_BUF_NUM; i++)
+            {
+                buf[i].assign(FAKE_CAP_BUF_SIZE, FAKE_POISON);
+                state[i].store(FAKE_BUF_QUEUED);
+            }
+        }
+
+        /* Dequeue the next buffer with the frame written by the camera.
+           Returns the physical address of the buffer like Camera::capture_image(). */
+        uint64_t capture_image()
+        {
+            cur = (cur + 1) % FAKE_CAP_BUF_NUM;
+            if (FAKE_BUF_QUEUED != state[cur].load())
+            {
+                num_error++;
+            }
+            num_frame++;
+            memset(buf[cur].data(), (uint8_t)num_frame, FAKE_CAP_BUF_SIZE);
+            memcpy(buf[cur].data(), &num_frame, sizeof(num_frame));
+            state[cur].store(FAKE_BUF_DEQUEUED);
+            return FAKE_CAP_BUF_ADDR + (uint64_t)cur * FAKE_CAP_BUF_SIZE;
+        }
+
+        /* Virtual address of the dequeued buffer */
+        uint8_t* get_img()
+        {
+            return buf[cur].data();
+        }
+
+        /* Requeue the buffer. The camera owns it from here and may overwrite it at any time. */
+        void capture_qbuf()
+        {
+            state[cur].store(FAKE_BUF_QUEUED);
+            memset(buf[cur].data(), FAKE_POISON, FAKE_CAP_BUF_SIZE);
+        }
+
+        /* Index of the buffer of the virtual address, -1 if it is not a capture buffer */
+        int32_t index_of(const void* addr)
+        {
+            int32_t i;
+
+            for (i = 0; i < FAKE_CAP_BUF_NUM; i++)
+            {
+                if (buf[i].data() == addr)
+                {
+                    return i;
+                }
+            }
+            return -1;
+        }
+
+        /* Virtual address of the capture buffer at the physical address, NULL if there is no buffer */
+        const uint8_t* to_virt(uint64_t phy_addr)
+        {
+            uint64_t offset = phy_addr - FAKE_CAP_BUF_ADDR;
+
+            if ((FAKE_CAP_BUF_ADDR > phy_addr) || (0 != offset % FAKE_CAP_BUF_SIZE)
+                || ((uint64_t)FAKE_CAP_BUF_NUM <= offset / FAKE_CAP_BUF_SIZE))
+            {
+                return NULL;
+            }
+            return buf[offset / FAKE_CAP_BUF_SIZE].data();
+        }
+
+        bool is_dequeued(int32_t index)
+        {
+            return FAKE_BUF_DEQUEUED == state[index].load();
+        }
+
+        std::atomic<uint64_t> num_error {0};
+
+    private:
+        std::vector<uint8_t> buf[FAKE_CAP_BUF_NUM];
+        std::atomic<uint32_t> state[FAKE_CAP_BUF_NUM];
+        int32_t cur = -1;
+        uint64_t num_frame = 0;
+};
+
+/*****************************************
+* Global Variables
+******************************************/
+static FakeCamera camera;
+static CaptureShare capture_share;
+static FrameRing frame_ring;
+static Event terminate_event;
+static Event inference_event;
+static Event capture_event;
+
+/* Same handover as the application */
+static atomic<uint8_t> inference_start (0);
+static uint64_t capture_address = 0;
+static uint64_t inference_frame_id = 0;
+static const uint8_t* display_buf[WL_BUF_NUM];
+static uint64_t display_frame_id[WL_BUF_NUM];
+
+/* Results */
+static atomic<uint64_t> num_bad_frame (0);
+static atomic<uint64_t> num_bad_address (0);
+static uint64_t num_early_qbuf = 0;
+static uint64_t num_displayed = 0;
+static atomic<uint64_t> num_inferred (0);
+static atomic<uint64_t> num_converted (0);
+
+/*****************************************
+* Function Name : check_frame
+* Description   : Read the frame in the buffer for the time of the stage like the pre-processing
+*                 or the image conversion, and check that it is not overwritten during the read.
+* Arguments     : data = frame
+*                 frame_id = expected frame ID
+*                 index = index of the capture buffer
+*                 time = time of the read (us)
+* Return value  : true if the frame is read correctly
+******************************************/
+static bool check_frame(const uint8_t* data, uint64_t frame_id, int32_t index, int32_t time)
+{
+    uint64_t id = 0;
+    int32_t pass;
+    int32_t i;
+
+    for (pass = 0; pass < 2; pass++)
+    {
+        if ((0 > index) || !camera.is_dequeued(index))
+        {
+            return false;
+        }
+        memcpy(&id, data, sizeof(id));
+        if (id != frame_id)
+        {
+            return false;
+        }
+        for (i = 1; i <= CHECK_POINT_NUM; i++)
+        {
+            if ((uint8_t)frame_id != data[(size_t)FAKE_CAP_BUF_SIZE * i / (CHECK_POINT_NUM + 1)])
+            {
+                return false;
+            }
+        }
+        if (0 == pass)
+        {
+            usleep(time);
+        }
+    }
+    return true;
+}
+
+/*****************************************
+* Function Name : fake_pre
+* Description   : Fake PreRuntime::Pre(), which reads the input image at the physical address.
+* Arguments     : pre_in_addr = physical address of the input image
+*                 frame_id = expected frame ID
+* Return value  : true if the frame is read correctly
+******************************************/
+static bool fake_pre(uint64_t pre_in_addr, uint64_t frame_id)
+{
+    const uint8_t* data = camera.to_virt(pre_in_addr);
+
+    if (NULL == data)
+    {
+        num_bad_address++;
+        return false;
+    }
+    return check_frame(data, frame_id, camera.index_of(data), FAKE_PRE_TIME);
+}
+
+/*****************************************
+* Function Name : inference_thread
+* Description   : Same as the loop of R_Inf_Thread: Pre(), release of the buffer, then Run().
+* Arguments     : -
+* Return value  : -
+******************************************/
+static void inference_thread()
+{
+    while (1)
+    {
+        while (!inference_start.load())
+        {
+            if (EVENT_SIGNALED != inference_event.wait(terminate_event, -1))
+            {
+                return;
+            }
+        }
+        if (!fake_pre(capture_address, inference_frame_id))
+        {
+            num_bad_frame++;
+        }
+        capture_share.release(CAPTURE_USER_INFERENCE);
+        inference_start.store(0);
+        num_inferred++;
+        /* Fake Run() */
+        usleep(FAKE_RUN_TIME);
+    }
+}
+
+/*****************************************
+* Function Name : image_thread
+* Description   : Same as the loop of R_Img_Thread: conversion of the capture buffer, then release of it.
+*                 The converted frame is displayed at once.
+* Arguments     : -
+* Return value  : -
+******************************************/
+static void image_thread()
+{
+    int32_t slot = -1;
+
+    while (1)
+    {
+        slot = frame_ring.acquire_convert();
+        if (0 > slot)
+        {
+            if (EVENT_SIGNALED != capture_event.wait(terminate_event, -1))
+            {
+                return;
+            }
+            continue;
+        }
+        if (!check_frame(display_buf[slot], display_frame_id[slot], camera.index_of(display_buf[slot]),
+            FAKE_CONVERT_TIME))
+        {
+            num_bad_frame++;
+        }
+        capture_share.release(CAPTURE_USER_DISPLAY);
+        frame_ring.publish_convert(slot);
+        num_converted++;
+        slot = frame_ring.acquire_display();
+        if (0 <= slot)
+        {
+            frame_ring.release_display(slot);
+        }
+    }
+}
+
+/*****************************************
+* Function Name : capture_loop
+* Description   : Same as the loop of R_Capture_Thread with CAPTURE_ZERO_COPY_MODE and DRPAI_INPUT_PADDING = 0.
+* Arguments     : num_frame = number of the frames to be captured
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+static int8_t capture_loop(uint64_t num_frame)
+{
+    uint64_t frame_id = 0;
+    uint64_t capture_addr = 0;
+    uint8_t* img_buffer = NULL;
+    int32_t slot = -1;
+    int8_t ret = 0;
+
+    for (frame_id = 1; frame_id <= num_frame; frame_id++)
+    {
+        usleep(FAKE_CAPTURE_INTERVAL);
+        capture_addr = camera.capture_image();
+        if (0 == capture_addr)
+        {
+            return -1;
+        }
+        img_buffer = camera.get_img();
+        if (!inference_start.load())
+        {
+            capture_address = capture_addr;
+            capture_share.take(CAPTURE_USER_INFERENCE);
+            inference_frame_id = frame_id;
+            inference_start.store(1);
+            inference_event.signal();
+        }
+
+        slot = frame_ring.acquire_capture();
+        if (0 <= slot)
+        {
+            capture_share.take(CAPTURE_USER_DISPLAY);
+            display_buf[slot] = img_buffer;
+            display_frame_id[slot] = frame_id;
+            frame_ring.publish_capture(slot);
+            num_displayed++;
+            capture_event.signal();
+        }
+
+        ret = capture_share.wait_released(terminate_event);
+        if (EVENT_SIGNALED != ret)
+        {
+            return -1;
+        }
+        if (0 != capture_share.get_refs())
+        {
+            num_early_qbuf++;
+        }
+        camera.capture_qbuf();
+    }
+    return 0;
+}
+
+/*****************************************
+* Function Name : usage
+* Description   : Print the usage of the test.
+* Arguments     : name = program name
+* Return value  : -
+******************************************/
+static void usage(const char* name)
+{
+    printf("Usage: %s [-n frames]\n", name);
+}
+
+/*****************************************
+* Function Name : main
+* Description   : Run the capture, inference and image threads with the fake camera and check that
+*                 every frame is read at the address of its buffer before the buffer is requeued.
+* Arguments     : argc = number of arguments
+*                 -n = number of the frames (2000 if omitted)
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int32_t main(int32_t argc, char* argv[])
+{
+    uint64_t num_frame = 2000;
+    int8_t ret = 0;
+    bool ok = true;
+
+    for (int32_t a = 1; a < argc; a++)
+    {
+        string arg = argv[a];
+        if (("-n" == arg) && (a + 1 < argc))
+        {
+            num_frame = strtoull(argv[++a], NULL, 10);
+        }
+        else
+        {
+            usage(argv[0]);
+            return -1;
+        }
+    }
+    if ((0 != terminate_event.init()) || (0 != inference_event.init()) || (0 != capture_event.init())
+        || (0 != capture_share.init()))
+    {
+        return -1;
+    }
+
+    std::thread inference(inference_thread);
+    std::thread image(image_thread);
+    ret = capture_loop(num_frame);
+    terminate_event.signal();
+    inference.join();
+    image.join();
+
+    printf("Frames captured     : %lu\n", (unsigned long)num_frame);
+    printf("Pre-processing      : %lu frames\n", (unsigned long)num_inferred.load());
+    printf("Image conversion    : %lu frames\n", (unsigned long)num_converted.load());
+    printf("Frames overwritten  : %lu\n", (unsigned long)num_bad_frame.load());
+    printf("Wrong address       : %lu\n", (unsigned long)num_bad_address.load());
+    printf("Requeued while read : %lu\n", (unsigned long)num_early_qbuf);
+
+    ok = (0 == ret)
+        && (0 == num_bad_frame.load())
+        && (0 == camera.num_error.load())
+        && (0 == num_bad_address.load())
+        && (0 == num_early_qbuf)
+        && (0 == capture_share.get_refs())
+        && (0 < num_inferred.load())
+        && (num_converted.load() == num_displayed);
+    printf("%s\n", ok ? "OK" : "NG");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : capture_share.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for Ultralytics YOLOV5 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "capture_share.h"
+
+CaptureShare::CaptureShare()
+{
+    int32_t i;
+
+    refs.store(0);
+    for (i = 0; i < CAPTURE_USER_NUM; i++)
+    {
+        taken[i].store(0);
+    }
+}
+
+CaptureShare::~CaptureShare()
+{
+    close();
+}
+
+/*****************************************
+* Function Name : init
+* Description   : Create the event to wake up Capture Thread.
+* Arguments     : -
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t CaptureShare::init()
+{
+    return release_event.init();
+}
+
+/*****************************************
+* Function Name : close
+* Description   : Close the event.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void CaptureShare::close()
+{
+    release_event.close();
+}
+
+/*****************************************
+* Function Name : take
+* Description   : Give the current capture buffer to the reader (Capture Thread).
+*                 Called before the buffer is handed over to the reader thread.
+* Arguments     : user = CAPTURE_USER_INFERENCE or CAPTURE_USER_DISPLAY
+* Return value  : -
+******************************************/
+void CaptureShare::take(int32_t user)
+{
+    refs++;
+    taken[user].store(1);
+}
+
+/*****************************************
+* Function Name : release
+* Description   : Release the reference taken for the reader.
+*                 Capture Thread is woken up to requeue the buffer when all references are released.
+*                 Nothing is done if the buffer was not given to the reader (e.g. it was copied).
+* Arguments     : user = CAPTURE_USER_INFERENCE or CAPTURE_USER_DISPLAY
+* Return value  : -
+******************************************/
+void CaptureShare::release(int32_t user)
+{
+    if (taken[user].exchange(0) && (1 == refs.fetch_sub(1)))
+    {
+        release_event.signal();
+    }
+}
+
+/*****************************************
+* Function Name : wait_released
+* Description   : Sleep until all references are released (Capture Thread).
+* Arguments     : terminate = terminate event
+* Return value  : EVENT_SIGNALED if all references are released,
+*                 EVENT_TERMINATED or EVENT_ERROR otherwise
+******************************************/
+int8_t CaptureShare::wait_released(Event& terminate)
+{
+    int8_t ret = EVENT_SIGNALED;
+
+    /* The event may be left signaled by the previous buffer, so the count is checked again. */
+    while (0 < refs.load())
+    {
+        ret = release_event.wait(terminate, -1);
+        if ((EVENT_ERROR == ret) || (EVENT_TERMINATED == ret))
+        {
+            return ret;
+        }
+    }
+    return EVENT_SIGNALED;
+}
+
+/*****************************************
+* Function Name : get_refs
+* Description   : Get the number of the references to the current capture buffer.
+* Arguments     : -
+* Return value  : number of the references
+******************************************/
+int32_t CaptureShare::get_refs()
+{
+    return refs.load();
+}
@@ -0,0 +1,45 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : capture_share.h
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for Ultralytics YOLOV5 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+#ifndef CAPTURE_SHARE_H
+#define CAPTURE_SHARE_H
+
+#include "define.h"
+#include "event.h"
+
+/* Readers of the V4L2 capture buffer */
+#define CAPTURE_USER_INFERENCE      (0)     /* AI Inference Thread (pre-processing) */
+#define CAPTURE_USER_DISPLAY        (1)     /* Image Thread (image conversion) */
+#define CAPTURE_USER_NUM            (2)
+
+/* References to the dequeued V4L2 capture buffer, which is read by the threads without copying.
+   Capture Thread takes a reference for each reader and requeues the buffer after wait_released(),
+   i.e. after all readers have called release(). */
+class CaptureShare
+{
+    public:
+        CaptureShare();
+        ~CaptureShare();
+
+        int8_t init();
+        void close();
+        void take(int32_t user);
+        void release(int32_t user);
+        int8_t wait_released(Event& terminate);
+        int32_t get_refs();
+
+    private:
+        std::atomic<int32_t> refs;
+        /* Set while the buffer is given to the reader */
+        std::atomic<uint8_t> taken[CAPTURE_USER_NUM];
+        /* Readers -> Capture Thread: the last reference is released */
+        Event release_event;
+};
+
+#endif
@@ -0,0 +1,466 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : det_log.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for Ultralytics YOLOV5 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "det_log.h"
+#include <algorithm>
+#include <cstddef>
+
+static_assert(48 == sizeof(det_log_record_t), "det_log_record_t is a file format");
+
+DetLogReader::DetLogReader()
+{
+    map_addr = NULL;
+    map_size = 0;
+    header = NULL;
+    num_record = 0;
+}
+
+DetLogReader::~DetLogReader()
+{
+    close();
+}
+
+/*****************************************
+* Function Name : open
+* Description   : Map the detection log file.
+*                 The record not written completely at the end is ignored.
+* Arguments     : path = path of the log file
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t DetLogReader::open(const std::string& path)
+{
+    int32_t fd = -1;
+    struct stat st;
+    void* addr = NULL;
+
+    close();
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (0 > fd)
+    {
+        fprintf(stderr, "[ERROR] Failed to open the detection log : %s\n", path.c_str());
+        return -1;
+    }
+    if ((0 != fstat(fd, &st)) || ((uint64_t)st.st_size < sizeof(det_log_header)))
+    {
+        fprintf(stderr, "[ERROR] Invalid detection log : %s\n", path.c_str());
+        ::close(fd);
+        return -1;
+    }
+    addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (MAP_FAILED == addr)
+    {
+        fprintf(stderr, "[ERROR] Failed to map the detection log : errno=%d\n", errno);
+        return -1;
+    }
+    map_addr = (uint8_t*)addr;
+    map_size = st.st_size;
+    header = (const det_log_header*)map_addr;
+
+    if ((0 != memcmp(header->magic, DET_LOG_MAGIC, sizeof(header->magic)))
+        || (DET_LOG_VERSION != header->version)
+        || (sizeof(det_log_record_t) != header->record_size))
+    {
+        fprintf(stderr, "[ERROR] Invalid detection log header : %s\n", path.c_str());
+        close();
+        return -1;
+    }
+    num_record = (map_size - sizeof(det_log_header)) / sizeof(det_log_record_t);
+    return 0;
+}
+
+/*****************************************
+* Function Name : close
+* Description   : Unmap the detection log file.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void DetLogReader::close()
+{
+    if (NULL != map_addr)
+    {
+        munmap(map_addr, map_size);
+    }
+    map_addr = NULL;
+    map_size = 0;
+    header = NULL;
+    num_record = 0;
+}
+
+/*****************************************
+* Function Name : get_num_record
+* Description   : Get the number of the records in the log.
+* Arguments     : -
+* Return value  : number of the records
+******************************************/
+uint64_t DetLogReader::get_num_record()
+{
+    return num_record;
+}
+
+/*****************************************
+* Function Name : get_num_dropped_frame
+* Description   : Get the number of the frames dropped by the application.
+*                 0 if the application did not close the log.
+* Arguments     : -
+* Return value  : number of the frames
+******************************************/
+uint64_t DetLogReader::get_num_dropped_frame()
+{
+    return (NULL == header) ? 0 : header->num_dropped_frame;
+}
+
+/*****************************************
+* Function Name : get_record
+* Description   : Get the record.
+* Arguments     : index = record index in the log
+* Return value  : record
+******************************************/
+const det_log_record_t* DetLogReader::get_record(uint64_t index)
+{
+    return (const det_log_record_t*)(map_addr + sizeof(det_log_header)) + index;
+}
+
+DetLogger::DetLogger()
+{
+    fd = -1;
+    flush_interval = 0;
+    head.store(0);
+    tail.store(0);
+    num_dropped_frame.store(0);
+    frame_dropped = false;
+    failed.store(false);
+}
+
+DetLogger::~DetLogger()
+{
+    close();
+}
+
+/*****************************************
+* Function Name : open
+* Description   : Create the detection log file and start the writer thread.
+*                 The ring is allocated here so that push does not allocate.
+* Arguments     : path = path of the log file
+*                 num_record = number of the records in the ring (power of 2)
+*                 interval = max time between two writes [ms]
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t DetLogger::open(const std::string& path, uint32_t num_record, int32_t interval)
+{
+    det_log_header header;
+
+    close();
+    if ((2 > num_record) || (0 != (num_record & (num_record - 1))))
+    {
+        fprintf(stderr, "[ERROR] Invalid detection log setting : %u records\n", num_record);
+        return -1;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DET_LOG_MAGIC, sizeof(header.magic));
+    header.version = DET_LOG_VERSION;
+    header.record_size = sizeof(det_log_record_t);
+
+    errno = 0;
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (0 > fd)
+    {
+        fprintf(stderr, "[ERROR] Failed to create the detection log : %s errno=%d\n", path.c_str(), errno);
+        return -1;
+    }
+    if ((ssize_t)sizeof(header) != write(fd, &header, sizeof(header)))
+    {
+        fprintf(stderr, "[ERROR] Failed to write the detection log header : errno=%d\n", errno);
+        close();
+        return -1;
+    }
+    if ((0 != fill_event.init()) || (0 != stop_event.init()))
+    {
+        close();
+        return -1;
+    }
+
+    flush_interval = interval;
+    /* Touch all pages so that push does not page-fault. */
+    ring.assign(num_record, det_log_record_t());
+    head.store(0);
+    tail.store(0);
+    num_dropped_frame.store(0);
+    frame_dropped = false;
+    failed.store(false);
+    try
+    {
+        writer = std::thread(&DetLogger::writer_loop, this);
+    }
+    catch (const std::system_error& e)
+    {
+        fprintf(stderr, "[ERROR] Failed to create the detection log writer thread : %s\n", e.what());
+        close();
+        return -1;
+    }
+    return 0;
+}
+
+/*****************************************
+* Function Name : push
+* Description   : Copy the record to the ring. Called only by one thread.
+*                 The record is dropped if the ring is full, which does not happen after begin_frame().
+* Arguments     : record = record to be written
+* Return value  : 0 if the record is queued
+*                 not 0 if the record is dropped
+******************************************/
+int8_t DetLogger::push(const det_log_record_t& record)
+{
+    uint64_t h = head.load(std::memory_order_relaxed);
+    uint64_t t = tail.load(std::memory_order_acquire);
+
+    if ((0 > fd) || failed.load(std::memory_order_relaxed))
+    {
+        return -1;
+    }
+    if (ring.size() <= h - t)
+    {
+        return -1;
+    }
+    ring[h & (ring.size() - 1)] = record;
+    head.store(h + 1, std::memory_order_release);
+    /* Wake up the writer thread once when the ring gets half full, otherwise it wakes up by the interval. */
+    if (ring.size() / 2 == h + 1 - t)
+    {
+        fill_event.signal();
+    }
+    return 0;
+}
+
+/*****************************************
+* Function Name : begin_frame
+* Description   : Reserve the ring for the boxes and the frame record of the next frame.
+*                 If the ring does not have room for all of them, the whole frame is dropped:
+*                 push_box() and push_frame() of the frame do nothing.
+*                 The room only grows until the frame is pushed, because only the writer thread frees it.
+* Arguments     : num_box = number of the boxes of the frame
+* Return value  : 0 if the frame will be queued
+*                 not 0 if the frame is dropped
+******************************************/
+int8_t DetLogger::begin_frame(uint32_t num_box)
+{
+    uint64_t h = head.load(std::memory_order_relaxed);
+    uint64_t t = tail.load(std::memory_order_acquire);
+
+    frame_dropped = false;
+    if ((0 > fd) || failed.load(std::memory_order_relaxed))
+    {
+        return -1;
+    }
+    if (ring.size() - (h - t) < (uint64_t)num_box + 1)
+    {
+        frame_dropped = true;
+        num_dropped_frame.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+    return 0;
+}
+
+/*****************************************
+* Function Name : push_box
+* Description   : Queue a detection of the frame. Called after begin_frame().
+* Arguments     : frame_id = capture frame ID
+*                 cls = class
+*                 prob = probability
+*                 x, y = center of the box in the DRP-AI input size
+*                 w, h = size of the box in the DRP-AI input size
+* Return value  : 0 if the record is queued
+*                 not 0 if the record is dropped
+******************************************/
+int8_t DetLogger::push_box(uint64_t frame_id, uint32_t cls, float prob, float x, float y, float w, float h)
+{
+    det_log_record_t record;
+
+    if (frame_dropped)
+    {
+        return -1;
+    }
+    memset(&record, 0, sizeof(record));
+    record.type = DET_LOG_BOX;
+    record.frame_id = frame_id;
+    record.box.cls = cls;
+    record.box.prob = prob;
+    record.box.x = x;
+    record.box.y = y;
+    record.box.w = w;
+    record.box.h = h;
+    return push(record);
+}
+
+/*****************************************
+* Function Name : push_frame
+* Description   : Queue the end of the detections of the frame with the time of each stage.
+* Arguments     : frame_id = capture frame ID
+*                 frame_no = inference count
+*                 capture_time = capture time of the input image [ns] (CLOCK_REALTIME)
+*                 pre_time = pre-processing time [ms]
+*                 inf_time = inference time [ms]
+*                 post_time = post-processing time [ms]
+*                 num_box = number of the detections
+* Return value  : 0 if the record is queued
+*                 not 0 if the record is dropped
+******************************************/
+int8_t DetLogger::push_frame(uint64_t frame_id, uint64_t frame_no, int64_t capture_time,
+    float pre_time, float inf_time, float post_time, uint32_t num_box)
+{
+    det_log_record_t record;
+
+    if (frame_dropped)
+    {
+        frame_dropped = false;
+        return -1;
+    }
+    memset(&record, 0, sizeof(record));
+    record.type = DET_LOG_FRAME;
+    record.frame_id = frame_id;
+    record.frame.frame_no = frame_no;
+    record.frame.capture_time = capture_time;
+    record.frame.pre_time = pre_time;
+    record.frame.inf_time = inf_time;
+    record.frame.post_time = post_time;
+    record.frame.num_box = num_box;
+    return push(record);
+}
+
+/*****************************************
+* Function Name : writer_loop
+* Description   : Write the pushed records every flush_interval or when the ring is half full,
+*                 until close() is requested. The records already pushed are written before the thread ends.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void DetLogger::writer_loop()
+{
+    int8_t ret = 0;
+
+    while (1)
+    {
+        ret = fill_event.wait(stop_event, flush_interval);
+        if (0 != flush())
+        {
+            /* Stop logging. The records written so far are kept. */
+            failed.store(true);
+            break;
+        }
+        if ((EVENT_TERMINATED == ret) || (EVENT_ERROR == ret))
+        {
+            break;
+        }
+    }
+}
+
+/*****************************************
+* Function Name : flush
+* Description   : Write the records in the ring to the file with one write per contiguous part of the ring.
+* Arguments     : -
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t DetLogger::flush()
+{
+    uint64_t t = tail.load(std::memory_order_relaxed);
+    uint64_t h = head.load(std::memory_order_acquire);
+    uint64_t index = 0;
+    uint64_t num = 0;
+    size_t size = 0;
+    size_t done = 0;
+    ssize_t ret = 0;
+
+    while (t < h)
+    {
+        index = t & (ring.size() - 1);
+        num = std::min(h - t, ring.size() - index);
+        size = num * sizeof(det_log_record_t);
+        for (done = 0; done < size; done += ret)
+        {
+            errno = 0;
+            ret = write(fd, (const uint8_t*)&ring[index] + done, size - done);
+            if (0 > ret)
+            {
+                if (EINTR == errno)
+                {
+                    ret = 0;
+                    continue;
+                }
+                fprintf(stderr, "[ERROR] Failed to write the detection log : errno=%d\n", errno);
+                return -1;
+            }
+        }
+        t += num;
+        /* The records are free for push from here. */
+        tail.store(t, std::memory_order_release);
+    }
+    return 0;
+}
+
+/*****************************************
+* Function Name : close
+* Description   : Write the pushed records, stop the writer thread, record the number of the dropped frames
+*                 in the header and close the file.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void DetLogger::close()
+{
+    uint64_t dropped = 0;
+
+    if (writer.joinable())
+    {
+        stop_event.signal();
+        writer.join();
+    }
+    if (0 <= fd)
+    {
+        dropped = num_dropped_frame.load();
+        if ((ssize_t)sizeof(dropped) != pwrite(fd, &dropped, sizeof(dropped),
+            offsetof(det_log_header, num_dropped_frame)))
+        {
+            fprintf(stderr, "[ERROR] Failed to update the detection log header : errno=%d\n", errno);
+        }
+        ::close(fd);
+    }
+    fd = -1;
+    fill_event.close();
+    stop_event.close();
+    ring.clear();
+    ring.shrink_to_fit();
+}
+
+/*****************************************
+* Function Name : get_num_written
+* Description   : Get the number of records written to the file.
+* Arguments     : -
+* Return value  : number of the records
+******************************************/
+uint64_t DetLogger::get_num_written()
+{
+    return tail.load();
+}
+
+/*****************************************
+* Function Name : get_num_dropped_frame
+* Description   : Get the number of frames dropped because the ring was full.
+* Arguments     : -
+* Return value  : number of the frames
+******************************************/
+uint64_t DetLogger::get_num_dropped_frame()
+{
+    return num_dropped_frame.load();
+}
@@ -0,0 +1,72 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : fp16_convert.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for Ultralytics Detection YOLOv5 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "fp16_convert.h"
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__F16C__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/*****************************************
+* Function Name : float16_to_float32_array
+* Description   : Convert the FP16 array into the FP32 array.
+*                 Arm (RZ/V2H) : NEON vcvt_f32_f16, 8 elements per iteration
+*                 x86 with F16C: vcvtph2ps, 8 elements per iteration
+*                 x86 SSE2     : same bit operation as float16_to_float32, 4 elements per iteration
+*                 The remaining elements are converted by float16_to_float32.
+* Arguments     : src = FP16 array
+*                 dst = FP32 array
+*                 num = number of elements
+* Return value  : -
+******************************************/
+void float16_to_float32_array(const uint16_t* src, float* dst, int64_t num)
+{
+    int64_t i = 0;
+
+#if defined(__ARM_NEON)
+    for (; i + 8 <= num; i += 8)
+    {
+        float16x4_t h0 = vreinterpret_f16_u16(vld1_u16(src + i));
+        float16x4_t h1 = vreinterpret_f16_u16(vld1_u16(src + i + 4));
+        vst1q_f32(dst + i,     vcvt_f32_f16(h0));
+        vst1q_f32(dst + i + 4, vcvt_f32_f16(h1));
+    }
+#elif defined(__F16C__)
+    for (; i + 8 <= num; i += 8)
+    {
+        __m128i h = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+    }
+#elif defined(__SSE2__)
+    const __m128i mask_exp_mant = _mm_set1_epi32(0x7FFF);
+    const __m128i mask_sign = _mm_set1_epi32(0x8000);
+    const __m128i inf_nan = _mm_set1_epi32(0x7F800000);
+    const __m128i th_inf_nan = _mm_set1_epi32(0x0F7FFFFF);
+    const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32(0x77800000)); /* 2^112 */
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= num; i += 4)
+    {
+        __m128i h = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)(src + i)), zero);
+        __m128i exp_mant = _mm_slli_epi32(_mm_and_si128(h, mask_exp_mant), 13);
+        __m128i sign = _mm_slli_epi32(_mm_and_si128(h, mask_sign), 16);
+        __m128i bits = _mm_castps_si128(_mm_mul_ps(_mm_castsi128_ps(exp_mant), magic));
+        bits = _mm_or_si128(bits, _mm_and_si128(_mm_cmpgt_epi32(exp_mant, th_inf_nan), inf_nan));
+        bits = _mm_or_si128(bits, sign);
+        _mm_storeu_ps(dst + i, _mm_castsi128_ps(bits));
+    }
+#endif
+    for (; i < num; i++)
+    {
+        dst[i] = float16_to_float32(src[i]);
+    }
+}
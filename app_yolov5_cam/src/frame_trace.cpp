@@ -0,0 +1,204 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : frame_trace.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for Ultralytics YOLOV5 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "frame_trace.h"
+#include <sys/syscall.h>
+
+/* Name of each trace_stage in the trace JSON */
+static const char* trace_stage_name[TRACE_STAGE_NUM] =
+{
+    "capture", "drp_copy", "pre", "run", "dfl", "decode", "nms", "convert", "draw", "commit", "frame",
+};
+
+/* Ring of the calling thread, set by register_thread */
+static thread_local trace_thread_t* current_thread = NULL;
+
+FrameTrace::FrameTrace()
+{
+    int32_t i;
+
+    for (i = 0; i < FRAME_TRACE_MAX_THREAD; i++)
+    {
+        threads[i].count.store(0);
+        threads[i].ready.store(0);
+    }
+    num_thread.store(0);
+}
+
+FrameTrace::~FrameTrace()
+{
+
+}
+
+/*****************************************
+* Function Name : register_thread
+* Description   : Allocate the ring of the calling thread.
+*                 The events of the threads not registered are not recorded.
+* Arguments     : name = thread name shown in the trace viewer
+* Return value  : -
+******************************************/
+void FrameTrace::register_thread(const char* name)
+{
+#if (1) == FRAME_TRACE_MODE
+    int32_t idx = num_thread.fetch_add(1);
+    uint64_t i;
+
+    if (FRAME_TRACE_MAX_THREAD <= idx)
+    {
+        fprintf(stderr, "[WARNING] Too many threads for the frame trace: %s\n", name);
+        return;
+    }
+    trace_thread_t* th = &threads[idx];
+    snprintf(th->name, sizeof(th->name), "%s", name);
+    th->tid = (int32_t)syscall(SYS_gettid);
+    th->events.reset(new trace_event_t[FRAME_TRACE_NUM_EVENT]);
+    for (i = 0; i < FRAME_TRACE_NUM_EVENT; i++)
+    {
+        th->events[i].seq.store(0, std::memory_order_relaxed);
+    }
+    th->ready.store(1, std::memory_order_release);
+    current_thread = th;
+#else
+    (void)name;
+#endif
+}
+
+/*****************************************
+* Function Name : record_event
+* Description   : Write the event to the ring of the calling thread.
+*                 The oldest event is overwritten when the ring is full.
+* Arguments     : stage = trace_stage
+*                 frame = capture frame ID
+*                 start = start time [ns]
+*                 end = end time [ns]
+*                 ref = related frame ID
+* Return value  : -
+******************************************/
+void FrameTrace::record_event(uint32_t stage, uint64_t frame, uint64_t start, uint64_t end, uint64_t ref)
+{
+    trace_thread_t* th = current_thread;
+
+    if (NULL == th)
+    {
+        return;
+    }
+    uint64_t idx = th->count.load(std::memory_order_relaxed);
+    trace_event_t* ev = &th->events[idx % FRAME_TRACE_NUM_EVENT];
+
+    /* Invalidate the slot while it is rewritten. */
+    ev->seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    ev->stage.store(stage, std::memory_order_relaxed);
+    ev->frame.store(frame, std::memory_order_relaxed);
+    ev->ref.store(ref, std::memory_order_relaxed);
+    ev->start.store(start, std::memory_order_relaxed);
+    ev->end.store(end, std::memory_order_relaxed);
+    ev->seq.store(idx + 1, std::memory_order_release);
+    th->count.store(idx + 1, std::memory_order_release);
+}
+
+/*****************************************
+* Function Name : export_json
+* Description   : Write the events in the rings as Chrome/Perfetto trace JSON.
+*                 Can be called while the threads are recording.
+*                 The frame stage is written as an async event, since the frames overlap.
+* Arguments     : path = output file path
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t FrameTrace::export_json(const char* path)
+{
+    FILE* fp;
+    int32_t num;
+    int32_t t;
+    uint64_t i;
+    uint64_t first;
+    uint64_t count;
+    uint64_t num_event = 0;
+    bool is_first = true;
+
+    errno = 0;
+    fp = fopen(path, "w");
+    if (NULL == fp)
+    {
+        fprintf(stderr, "[ERROR] Failed to open the frame trace file %s: errno=%d\n", path, errno);
+        return -1;
+    }
+    fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    num = std::min(num_thread.load(), (int32_t)FRAME_TRACE_MAX_THREAD);
+    for (t = 0; t < num; t++)
+    {
+        trace_thread_t* th = &threads[t];
+        if (0 == th->ready.load(std::memory_order_acquire))
+        {
+            continue;
+        }
+        fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+            is_first ? "" : ",\n", th->tid, th->name);
+        is_first = false;
+
+        count = th->count.load(std::memory_order_acquire);
+        first = (count > FRAME_TRACE_NUM_EVENT) ? (count - FRAME_TRACE_NUM_EVENT) : 0;
+        for (i = first; i < count; i++)
+        {
+            trace_event_t* ev = &th->events[i % FRAME_TRACE_NUM_EVENT];
+            if (i + 1 != ev->seq.load(std::memory_order_acquire))
+            {
+                continue;
+            }
+            uint32_t stage = ev->stage.load(std::memory_order_relaxed);
+            uint64_t frame = ev->frame.load(std::memory_order_relaxed);
+            uint64_t ref = ev->ref.load(std::memory_order_relaxed);
+            uint64_t start = ev->start.load(std::memory_order_relaxed);
+            uint64_t end = ev->end.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            /* Overwritten by the thread while reading */
+            if ((i + 1 != ev->seq.load(std::memory_order_relaxed)) || (TRACE_STAGE_NUM <= stage))
+            {
+                continue;
+            }
+
+            if (TRACE_FRAME == stage)
+            {
+                fprintf(fp, ",\n{\"name\":\"%s\",\"cat\":\"latency\",\"ph\":\"b\",\"id\":%lu,\"ts\":%.3f,\"pid\":1,\"tid\":%d,"
+                    "\"args\":{\"frame\":%lu,\"latency_ms\":%.3f}}",
+                    trace_stage_name[stage], (unsigned long)frame, start / 1000.0, th->tid,
+                    (unsigned long)frame, (end - start) / 1000000.0);
+                fprintf(fp, ",\n{\"name\":\"%s\",\"cat\":\"latency\",\"ph\":\"e\",\"id\":%lu,\"ts\":%.3f,\"pid\":1,\"tid\":%d}",
+                    trace_stage_name[stage], (unsigned long)frame, end / 1000.0, th->tid);
+            }
+            else
+            {
+                fprintf(fp, ",\n{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d,"
+                    "\"args\":{\"frame\":%lu",
+                    trace_stage_name[stage], start / 1000.0, (end - start) / 1000.0, th->tid, (unsigned long)frame);
+                if (TRACE_NO_FRAME != ref)
+                {
+                    fprintf(fp, ",\"result_frame\":%lu", (unsigned long)ref);
+                }
+                fprintf(fp, "}}");
+            }
+            num_event++;
+        }
+    }
+    fprintf(fp, "\n]}\n");
+
+    errno = 0;
+    if (0 != fclose(fp))
+    {
+        fprintf(stderr, "[ERROR] Failed to write the frame trace file %s: errno=%d\n", path, errno);
+        return -1;
+    }
+    printf("Frame Trace : %lu events written to %s\n", (unsigned long)num_event, path);
+    return 0;
+}
@@ -0,0 +1,159 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : latency_hist.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for Ultralytics YOLOV5 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "latency_hist.h"
+
+/* Name of each latency_stage */
+static const char* latency_stage_name[LATENCY_STAGE_NUM] =
+{
+    "capture", "copy", "pre", "run", "fp16", "dfl", "argmax", "decode", "nms", "convert", "draw", "commit", "frame",
+};
+
+LatencyHist::LatencyHist()
+{
+    int32_t i;
+
+    for (i = 0; i < LATENCY_HIST_BUCKET_NUM; i++)
+    {
+        counts[i].store(0);
+    }
+    count.store(0);
+    sum.store(0);
+    min.store(UINT64_MAX);
+    max.store(0);
+}
+
+LatencyHist::~LatencyHist()
+{
+
+}
+
+/*****************************************
+* Function Name : snapshot
+* Description   : Copy the histogram.
+*                 A value recorded during the snapshot may be missing from the counts or from count/sum/min/max.
+* Arguments     : snap = destination of the copy
+*                 reset = true to clear the histogram at the same time
+* Return value  : -
+******************************************/
+void LatencyHist::snapshot(latency_snapshot_t* snap, bool reset)
+{
+    int32_t i;
+
+    for (i = 0; i < LATENCY_HIST_BUCKET_NUM; i++)
+    {
+        snap->counts[i] = reset ? counts[i].exchange(0, std::memory_order_relaxed) : counts[i].load(std::memory_order_relaxed);
+    }
+    if (reset)
+    {
+        snap->count = count.exchange(0, std::memory_order_relaxed);
+        snap->sum = sum.exchange(0, std::memory_order_relaxed);
+        snap->min = min.exchange(UINT64_MAX, std::memory_order_relaxed);
+        snap->max = max.exchange(0, std::memory_order_relaxed);
+    }
+    else
+    {
+        snap->count = count.load(std::memory_order_relaxed);
+        snap->sum = sum.load(std::memory_order_relaxed);
+        snap->min = min.load(std::memory_order_relaxed);
+        snap->max = max.load(std::memory_order_relaxed);
+    }
+    if (UINT64_MAX == snap->min)
+    {
+        snap->min = 0;
+    }
+}
+
+/*****************************************
+* Function Name : get_upper
+* Description   : Get the largest value counted in the bucket.
+* Arguments     : index = bucket index
+* Return value  : value [ns]
+******************************************/
+uint64_t LatencyHist::get_upper(uint32_t index)
+{
+    uint32_t shift = index >> LATENCY_HIST_SUB_BITS;
+    uint64_t sub = index & ((1 << LATENCY_HIST_SUB_BITS) - 1);
+
+    if (1 >= shift)
+    {
+        return index;
+    }
+    shift--;
+    return ((((uint64_t)1 << LATENCY_HIST_SUB_BITS) + sub + 1) << shift) - 1;
+}
+
+/*****************************************
+* Function Name : percentile
+* Description   : Get the percentile of the latencies in the snapshot.
+*                 The result is the upper end of the bucket, and never more than the max.
+* Arguments     : snap = snapshot of the histogram
+*                 p = percentile (0 to 100)
+* Return value  : latency [ns], 0 if the snapshot is empty
+******************************************/
+uint64_t LatencyHist::percentile(const latency_snapshot_t* snap, double p)
+{
+    uint64_t total = 0;
+    uint64_t rank;
+    uint64_t acc = 0;
+    uint64_t value;
+    int32_t i;
+
+    for (i = 0; i < LATENCY_HIST_BUCKET_NUM; i++)
+    {
+        total += snap->counts[i];
+    }
+    if (0 == total)
+    {
+        return 0;
+    }
+    /* 1-based rank of the value at the percentile */
+    rank = (uint64_t)ceil(p / 100.0 * total);
+    if (1 > rank)
+    {
+        rank = 1;
+    }
+    if (rank > total)
+    {
+        rank = total;
+    }
+    for (i = 0; i < LATENCY_HIST_BUCKET_NUM; i++)
+    {
+        acc += snap->counts[i];
+        if (acc >= rank)
+        {
+            break;
+        }
+    }
+    value = get_upper(i);
+    /* The last bucket also counts the values out of the range. */
+    if ((0 < snap->max) && ((value > snap->max) || (LATENCY_HIST_BUCKET_NUM - 1 == i)))
+    {
+        value = snap->max;
+    }
+    return value;
+}
+
+/*****************************************
+* Function Name : get_stage_name
+* Description   : Get the name of the latency stage.
+* Arguments     : stage = latency_stage
+* Return value  : name
+******************************************/
+const char* LatencyHist::get_stage_name(uint32_t stage)
+{
+    if (LATENCY_STAGE_NUM <= stage)
+    {
+        return "unknown";
+    }
+    return latency_stage_name[stage];
+}
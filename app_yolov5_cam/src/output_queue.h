@@ -0,0 +1,70 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : output_queue.h
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for Ultralytics YOLOV5 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+#ifndef OUTPUT_QUEUE_H
+#define OUTPUT_QUEUE_H
+
+#include "define.h"
+#include "event.h"
+#include "tensor_view.h"
+
+/* DRP-AI outputs of one frame copied out of the DRP-AI output memory,
+   so that the next frame can run on DRP-AI during the CPU post-processing. */
+typedef struct output_slot
+{
+    std::vector<std::vector<uint8_t>> data;     /* copy of each output */
+    std::vector<std::tuple<InOutDataType, void*, int64_t>> outputs;   /* { data type, address in data, number of elements } */
+    uint64_t frame_no;          /* inference count */
+    uint64_t frame_id;          /* capture frame ID of the input image */
+    struct timespec capture_time;   /* capture time of the input image */
+    double pre_time;            /* pre-processing time [ms] */
+    double ai_time;             /* inference time [ms] */
+} output_slot_t;
+
+typedef struct output_queue_stats
+{
+    uint64_t num_pushed;        /* frames handed over to the post-processing stage */
+    uint64_t stall_push;        /* times the inference stage waited for a free slot (post-processing bound) */
+    uint64_t stall_pop;         /* times the post-processing stage waited for a frame (inference bound) */
+    uint32_t depth;             /* frames waiting for the post-processing now */
+    uint32_t max_depth;         /* max frames waiting for the post-processing */
+} output_queue_stats_t;
+
+/* Single producer (AI Inference Thread) / single consumer (Post-processing Thread) queue of
+   output_slot_t. The threads sleep on the events while the queue is full or empty. */
+class OutputQueue
+{
+    public:
+        OutputQueue();
+        ~OutputQueue();
+
+        int8_t init(uint32_t num_slot);
+        void close();
+        output_slot_t* acquire(Event& terminate);
+        int8_t copy_outputs(output_slot_t* slot, const std::tuple<InOutDataType, void*, int64_t>* outputs, int32_t num_output);
+        void push();
+        output_slot_t* front(Event& terminate);
+        void pop();
+        output_queue_stats_t get_stats();
+
+    private:
+        std::vector<output_slot_t> slots;
+        /* Slot (n % slots.size()) holds the n-th pushed frame. */
+        std::atomic<uint64_t> head;
+        std::atomic<uint64_t> tail;
+        /* Signaled by pop() for acquire() and by push() for front() */
+        Event free_event;
+        Event ready_event;
+
+        std::atomic<uint64_t> stall_push;
+        std::atomic<uint64_t> stall_pop;
+        std::atomic<uint32_t> max_depth;
+};
+
+#endif
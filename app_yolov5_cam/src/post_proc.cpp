@@ -0,0 +1,307 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : post_proc.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for Ultralytics Detection YOLOv5 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "post_proc.h"
+
+using namespace std;
+
+/*****************************************
+* Function Name : sigmoid
+* Description   : Helper function for YOLO Post Processing
+* Arguments     : x = input argument for the calculation
+* Return value  : sigmoid result of input x
+******************************************/
+float sigmoid(float x)
+{
+    return 1.0f/(1.0f + expf(-x));
+}
+
+/*****************************************
+* Function Name : logit
+* Description   : Helper function for YOLO Post Processing
+*                 Inverse of sigmoid used to compare the thresholds in logit space.
+* Arguments     : p = probability
+* Return value  : logit of p. -FLT_MAX if p <= 0, FLT_MAX if p >= 1.
+******************************************/
+float logit(float p)
+{
+    if (p <= 0) { return -FLT_MAX; }
+    if (p >= 1) { return FLT_MAX; }
+    return logf( p / (1.0f-p) );
+}
+
+/*****************************************
+* Function Name : softmax
+* Description   : Helper function for YOLO Post Processing
+* Arguments     : val[] = array to be computed softmax
+* Return value  : -
+******************************************/
+void softmax(float val[NUM_CLASS])
+{
+    float max_num = -FLT_MAX;
+    float sum = 0;
+    int32_t i;
+    for ( i = 0 ; i<NUM_CLASS ; i++ )
+    {
+        max_num = max(max_num, val[i]);
+    }
+
+    for ( i = 0 ; i<NUM_CLASS ; i++ )
+    {
+        val[i]= (float) exp(val[i] - max_num);
+        sum+= val[i];
+    }
+
+    for ( i = 0 ; i<NUM_CLASS ; i++ )
+    {
+        val[i]= val[i]/sum;
+    }
+    return;
+}
+
+/*****************************************
+* Function Name : index
+* Description   : Get the index of the bounding box attributes based on the input offset.
+* Arguments     : layer = view of the output layer.
+*                 offs = offset to access the bounding box attributesd.
+*                 channel = channel to access each bounding box attribute.
+* Return value  : index to access the bounding box attribute.
+******************************************/
+int32_t index(const tensor_view& layer, int32_t offs, int32_t channel)
+{
+    return offs + channel * layer.strides[1];
+}
+
+PostProc::PostProc()
+{
+
+}
+
+PostProc::~PostProc()
+{
+
+}
+
+/*****************************************
+* Function Name : set_outputs
+* Description   : Bind DRP-AI outputs to the tensor views.
+*                 Each output is bound to the view of its layer, identified by
+*                 the number of elements. FP32 outputs are read in place by the
+*                 post-processing and FP16 outputs are converted.
+* Arguments     : outputs = tuples of { data type, address of output data, number of elements }
+*                 num_output = number of outputs
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t PostProc::set_outputs(const std::tuple<InOutDataType, void*, int64_t>* outputs, int32_t num_output)
+{
+    int8_t ret = 0;
+    int32_t i = 0;
+    int32_t n = 0;
+    int32_t num_bound = 0;
+    int64_t output_size;
+    int32_t grid = 0;
+
+    for (i = 0; i < num_output; i++)
+    {
+        output_size = std::get<2>(outputs[i]);
+
+        for (n = 0; n < NUM_INF_OUT_LAYER; n++)
+        {
+            grid = num_grids[n];
+            if (output_size == (NUM_CLASS + 5) * NUM_BB * grid * grid)
+            {
+                ret = bind_tensor_view(output_layer[n], outputs[i], (NUM_CLASS + 5) * NUM_BB, grid, grid, true);
+                num_bound++;
+                break;
+            }
+        }
+        if (0 != ret)
+        {
+            break;
+        }
+    }
+    if ((0 == ret) && (NUM_INF_OUT_LAYER != num_bound))
+    {
+        fprintf(stderr, "[ERROR] Output number mismatch : %d (expected %d).\n", num_bound, NUM_INF_OUT_LAYER);
+        ret = -1;
+    }
+    return ret;
+}
+
+/*****************************************
+* Function Name : get_view
+* Description   : Get the tensor view bound to the output.
+* Arguments     : size = number of elements of the output
+* Return value  : tensor view
+*                 NULL if the output is not used
+******************************************/
+const tensor_view* PostProc::get_view(int64_t size)
+{
+    for (int32_t n = 0; n < NUM_INF_OUT_LAYER; n++)
+    {
+        if (size == output_layer[n].size)
+        {
+            return &output_layer[n];
+        }
+    }
+    return NULL;
+}
+
+/*****************************************
+* Function Name : decode
+* Description   : Process CPU post-processing for Yolov5
+* Arguments     : det_buff = detections over the threshold in DRP-AI input size
+* Return value  : -
+******************************************/
+void PostProc::decode(vector<detection>& det_buff)
+{
+    /* Following variables are required for correct_region_boxes in Darknet implementation*/
+    /* Note: This implementation refers to the "darknet detector test" */
+    float new_w, new_h;
+    float correct_w = 1.;
+    float correct_h = 1.;
+    if ((float) (MODEL_IN_W / correct_w) < (float) (MODEL_IN_H/correct_h) )
+    {
+        new_w = (float) MODEL_IN_W;
+        new_h = correct_h * MODEL_IN_W / correct_w;
+    }
+    else
+    {
+        new_w = correct_w * MODEL_IN_H / correct_h;
+        new_h = MODEL_IN_H;
+    }
+
+    int32_t n = 0;
+    int32_t b = 0;
+    int32_t y = 0;
+    int32_t x = 0;
+    int32_t offs = 0;
+    size_t i = 0;
+    float tx = 0;
+    float ty = 0;
+    float tw = 0;
+    float th = 0;
+    float tc = 0;
+    float center_x = 0;
+    float center_y = 0;
+    float box_w = 0;
+    float box_h = 0;
+    float objectness = 0;
+    uint8_t num_grid = 0;
+    float max_pred = 0;
+    float pred = 0;
+    int32_t pred_class = -1;
+    float probability = 0;
+    detection d;
+    float stride = 0;
+    const float* floatarr = NULL;
+    /* Thresholds in logit space */
+    float th_obj = logit(TH_PROB);
+    float th_cls = 0;
+
+    det_buff.clear();
+    for (n = 0; n<NUM_INF_OUT_LAYER; n++)
+    {
+        const tensor_view& layer = output_layer[n];
+        num_grid = layer.shape[3];
+        stride = layer.scale;
+        floatarr = layer.fp32;
+
+        for (b = 0;b<NUM_BB;b++)
+        {
+            for (y = 0;y<num_grid;y++)
+            {
+                for (x = 0;x<num_grid;x++)
+                {
+                    offs = anchor_offsets[n][b] + y * num_grid + x;
+                    tc = floatarr[index(layer, offs, 4)];
+
+                    /* sigmoid(tc) > TH_PROB */
+                    if (tc > th_obj)
+                    {
+                        objectness = sigmoid(tc);
+
+                        /* Get the class prediction. sigmoid does not change the argmax. */
+                        max_pred = -FLT_MAX;
+                        pred_class = -1;
+                        for (i = 0; i < NUM_CLASS; i++)
+                        {
+                            pred = floatarr[index(layer, offs, 5+i)];
+                            if (pred > max_pred)
+                            {
+                                pred_class = i;
+                                max_pred = pred;
+                            }
+                        }
+
+                        /* Store the result into the list if the probability is more than the threshold */
+                        /* sigmoid(max_pred) * objectness > TH_PROB */
+                        th_cls = logit(TH_PROB / objectness);
+                        if (max_pred > th_cls)
+                        {
+                            probability = sigmoid(max_pred) * objectness;
+
+                            tx = floatarr[offs];
+                            ty = floatarr[index(layer, offs, 1)];
+                            tw = floatarr[index(layer, offs, 2)];
+                            th = floatarr[index(layer, offs, 3)];
+
+                            /* Compute the bounding box */
+                            /*get_yolo_box/get_region_box in paper implementation*/
+                            center_x = (sigmoid(tx)+ float(x))* stride;
+                            center_y = (sigmoid(ty)+ float(y))* stride;
+                            center_x = center_x  / (float) MODEL_IN_W;
+                            center_y = center_y  / (float) MODEL_IN_H;
+                            tw = sigmoid(tw) * 2.0f;
+                            th = sigmoid(th) * 2.0f;
+                            box_w = tw * tw * anchors[n][2*b];
+                            box_h = th * th * anchors[n][2*b+1];
+                            box_w = box_w / (float) MODEL_IN_W;
+                            box_h = box_h / (float) MODEL_IN_H;
+
+                            /* Adjustment for size */
+                            /* correct_yolo/region_boxes */
+                            center_x = (center_x - (MODEL_IN_W - new_w) / 2.0f / MODEL_IN_W) / ((float) new_w / MODEL_IN_W);
+                            center_y = (center_y - (MODEL_IN_H - new_h) / 2.0f / MODEL_IN_H) / ((float) new_h / MODEL_IN_H);
+                            box_w *= (float) (MODEL_IN_W / new_w);
+                            box_h *= (float) (MODEL_IN_H / new_h);
+
+                            center_x = roundf(center_x * DRPAI_IN_WIDTH);
+                            center_y = roundf(center_y * DRPAI_IN_HEIGHT);
+                            box_w = roundf(box_w * DRPAI_IN_WIDTH);
+                            box_h = roundf(box_h * DRPAI_IN_HEIGHT);
+
+                            Box bb = {center_x, center_y, box_w, box_h};
+                            d = {bb, pred_class, probability};
+                            det_buff.push_back(d);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return;
+}
+
+/*****************************************
+* Function Name : nms_proc
+* Description   : Apply NMS to the detections.
+* Arguments     : det_buff = detections over the threshold in DRP-AI input size
+* Return value  : -
+******************************************/
+void PostProc::nms_proc(vector<detection>& det_buff)
+{
+    /* Non-Maximum Supression filter */
+    nms.NMS_Proc(det_buff, TH_NMS, DRPAI_IN_WIDTH, DRPAI_IN_HEIGHT);
+    return;
+}
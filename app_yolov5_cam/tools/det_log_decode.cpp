@@ -0,0 +1,182 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : det_log_decode.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for Ultralytics YOLOV5 with MIPI/USB Camera
+*                Offline decoder of the detection log written with DET_LOG_MODE.
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include <string>
+#include "define.h"
+#include "define_color_yolov5.h"
+#include "det_log.h"
+
+using namespace std;
+
+/*****************************************
+* Function Name : get_label
+* Description   : Get the label of the class.
+* Arguments     : cls = class
+* Return value  : label
+******************************************/
+static const char* get_label(uint32_t cls)
+{
+    return (cls < label_file_map.size()) ? label_file_map[cls].c_str() : "unknown";
+}
+
+/*****************************************
+* Function Name : print_text
+* Description   : Print the detections and the time of the frame in the same form as the text log.
+* Arguments     : boxes = box records of the frame
+*                 frame = frame record
+* Return value  : -
+******************************************/
+static void print_text(const vector<const det_log_record_t*>& boxes, const det_log_record_t* frame)
+{
+    uint32_t i = 0;
+
+    printf("Inference ----------- No. %lu (Frame ID %lu)\n",
+        (unsigned long)(frame->frame.frame_no + 1), (unsigned long)frame->frame_id);
+    for (i = 0; i < boxes.size(); i++)
+    {
+        const det_log_record_t* b = boxes[i];
+        printf(" Bounding Box Number : %u\n", i + 1);
+        printf(" Bounding Box        : (X, Y, W, H) = (%d, %d, %d, %d)\n",
+            (int)b->box.x, (int)b->box.y, (int)b->box.w, (int)b->box.h);
+        printf(" Detected Class      : %s (Class %u)\n", get_label(b->box.cls), b->box.cls);
+        printf(" Probability         : %.1f %%\n", b->box.prob * 100);
+    }
+    printf(" Bounding Box Count  : %u\n", frame->frame.num_box);
+    printf("Total AI Time  : %.1f [ms]\n", frame->frame.pre_time + frame->frame.inf_time + frame->frame.post_time);
+    printf("PreProcess     : %.1f [ms]\n", frame->frame.pre_time);
+    printf("Inference      : %.1f [ms]\n", frame->frame.inf_time);
+    printf("PostProcess    : %.1f [ms]\n", frame->frame.post_time);
+}
+
+/*****************************************
+* Function Name : print_csv
+* Description   : Print one row per detection with the time of the frame.
+*                 A frame without detection has one row with the box columns empty.
+* Arguments     : boxes = box records of the frame
+*                 frame = frame record
+* Return value  : -
+******************************************/
+static void print_csv(const vector<const det_log_record_t*>& boxes, const det_log_record_t* frame)
+{
+    char head[256];
+    uint32_t i = 0;
+
+    snprintf(head, sizeof(head), "%lu,%lu,%ld,%.3f,%.3f,%.3f,%u",
+        (unsigned long)(frame->frame.frame_no + 1), (unsigned long)frame->frame_id, (long)frame->frame.capture_time,
+        frame->frame.pre_time, frame->frame.inf_time, frame->frame.post_time, frame->frame.num_box);
+    if (boxes.empty())
+    {
+        printf("%s,,,,,,,\n", head);
+    }
+    for (i = 0; i < boxes.size(); i++)
+    {
+        const det_log_record_t* b = boxes[i];
+        printf("%s,%u,%s,%.4f,%.1f,%.1f,%.1f,%.1f\n", head,
+            b->box.cls, get_label(b->box.cls), b->box.prob, b->box.x, b->box.y, b->box.w, b->box.h);
+    }
+}
+
+/*****************************************
+* Function Name : usage
+* Description   : Print the usage of the decoder.
+* Arguments     : name = program name
+* Return value  : -
+******************************************/
+static void usage(const char* name)
+{
+    printf("Usage: %s <detection log> [-c]\n", name);
+}
+
+/*****************************************
+* Function Name : main
+* Description   : Print the detections and the time of each frame in the detection log.
+* Arguments     : argc = number of arguments
+*                 argv[1] = detection log file
+*                 -c = print in CSV instead of the text log form
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int32_t main(int32_t argc, char* argv[])
+{
+    string log_path;
+    bool csv = false;
+    DetLogReader reader;
+    vector<const det_log_record_t*> boxes;
+    uint64_t num_frame = 0;
+    uint64_t i = 0;
+
+    for (int32_t a = 1; a < argc; a++)
+    {
+        string arg = argv[a];
+        if ("-c" == arg)
+        {
+            csv = true;
+        }
+        else if (log_path.empty() && ('-' != arg[0]))
+        {
+            log_path = arg;
+        }
+        else
+        {
+            usage(argv[0]);
+            return -1;
+        }
+    }
+    if (log_path.empty())
+    {
+        usage(argv[0]);
+        return -1;
+    }
+    if (0 != reader.open(log_path))
+    {
+        return -1;
+    }
+
+    if (csv)
+    {
+        printf("inference_no,frame_id,capture_time_ns,pre_ms,inference_ms,post_ms,box_count,class,label,prob,x,y,w,h\n");
+    }
+    for (i = 0; i < reader.get_num_record(); i++)
+    {
+        const det_log_record_t* record = reader.get_record(i);
+        if (DET_LOG_BOX == record->type)
+        {
+            /* A box of another frame is left when the application stopped before its frame record. */
+            if (!boxes.empty() && (boxes.back()->frame_id != record->frame_id))
+            {
+                boxes.clear();
+            }
+            boxes.push_back(record);
+        }
+        else if (DET_LOG_FRAME == record->type)
+        {
+            if (!boxes.empty() && (boxes.back()->frame_id != record->frame_id))
+            {
+                boxes.clear();
+            }
+            if (csv)
+            {
+                print_csv(boxes, record);
+            }
+            else
+            {
+                print_text(boxes, record);
+            }
+            boxes.clear();
+            num_frame++;
+        }
+    }
+    fprintf(stderr, "%lu frames, %lu frames dropped by the application\n",
+        (unsigned long)num_frame, (unsigned long)reader.get_num_dropped_frame());
+    return 0;
+}
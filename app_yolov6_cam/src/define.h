@@ -58,11 +58,105 @@
 /*Display AI frame rate*/
 #undef DISP_AI_FRAME_RATE
 
+/* Tensor record mode for the offline post-processing benchmark (bench/).
+   The DRP-AI outputs of each frame are copied to a ring and appended to TENSOR_RECORD_FILE by a writer thread.
+   n = 0: Disable
+   n = 1: Enable
+   */
+#define TENSOR_RECORD_MODE          (0)
+#define TENSOR_RECORD_FILE          "tensor_record.bin"
+/* Frames buffered between the post-processing thread and the writer thread. A frame is dropped when the ring is full. */
+#define TENSOR_RECORD_RING_NUM      (4)
+/* Max number of frames to be recorded (0: no limit) */
+#define TENSOR_RECORD_MAX_FRAME     (300)
+
+/* Frame trace mode.
+   Each frame carries the capture frame ID, and the capture, DRP-AI input copy, Pre, Run, DFL, decode, NMS,
+   conversion, drawing and Wayland commit of the frame are recorded in a ring per thread.
+   The rings are written to FRAME_TRACE_FILE as Chrome/Perfetto trace JSON at the exit and when SIGUSR1 is received.
+   The capture time is CLOCK_MONOTONIC when Camera::capture_image() returns, not the V4L2 buffer timestamp,
+   because Camera does not expose the dequeued v4l2_buffer. The capture-to-commit latency of a frame therefore
+   does not include the time from the sensor exposure to VIDIOC_DQBUF.
+   n = 0: Disable
+   n = 1: Enable
+   */
+#define FRAME_TRACE_MODE            (0)
+#define FRAME_TRACE_FILE            "frame_trace.json"
+/* Events kept per thread. The oldest event is overwritten when the ring is full. */
+#define FRAME_TRACE_NUM_EVENT       (8192)
+#define FRAME_TRACE_MAX_THREAD      (8)
+
+/* Detection log mode.
+   The detections and the time of each stage of each frame are pushed as fixed-size binary records
+   to a lock-free ring, and a writer thread appends them to logs/<timestamp>_app_yolov6_cam.det in batches.
+   tools/det_log_decode.cpp converts the file to text or CSV.
+   n = 0: Disable (the detections are written to the text log on the post-processing thread)
+   n = 1: Enable
+   */
+#define DET_LOG_MODE                (1)
+/* Records buffered in the ring (power of 2). A record is dropped when the ring is full. */
+#define DET_LOG_RING_NUM            (4096)
+/* The writer thread writes the records at least once in this time. (ms) */
+#define DET_LOG_FLUSH_INTERVAL      (500)
+
+/* Detection shared memory mode.
+   The detections of each frame are published to the POSIX shared memory DET_SHM_NAME
+   (/dev/shm/app_yolov6_cam_det), a ring of DET_SHM_SLOT_NUM fixed-size records guarded by sequence counters.
+   Other processes map it read-only with DetSubscriber (det_shm.h) and read the results without a system call.
+   n = 0: Disable
+   n = 1: Enable
+   */
+#define DET_SHM_MODE                (1)
+#define DET_SHM_NAME                "/app_yolov6_cam_det"
+/* Frames kept in the ring. A reader later than this misses the older frames. */
+#define DET_SHM_SLOT_NUM            (16)
+
+/* Metrics export mode.
+   The Metrics Thread writes a snapshot of the frame counters, the latency percentiles of each stage,
+   the box counts and the DRP frequency settings in the Prometheus text format
+   to each client connecting to METRICS_SOCKET_PATH (Unix domain socket).
+   n = 0: Disable
+   n = 1: Enable
+   */
+#define METRICS_MODE                (1)
+#define METRICS_SOCKET_PATH         "/tmp/app_yolov6_cam_metrics.sock"
+/* A client that does not read the snapshot within this time is dropped. (seconds) */
+#define METRICS_SEND_TIMEOUT        (1)
+/* Min interval of the warnings when a client cannot be accepted (seconds) */
+#define METRICS_WARNING_INTERVAL    (10)
+/* Wait before accepting the client again after a temporary failure (ms) */
+#define METRICS_RETRY_INTERVAL      (100)
+
+/* Overlay plane mode.
+   Bounding boxes and texts are drawn into the overlay surface only when the AI result is updated,
+   and the Wayland compositor blends the overlay surface on the camera image.
+   n = 0: Disable (draw on the camera image every frame)
+   n = 1: Enable
+   */
+#define DISP_OVERLAY_MODE           (0)
+
+/* Zero-copy capture mode.
+   The V4L2 capture buffer is shared by the inference and the display instead of being copied to
+   the DRP-AI input buffer and the display buffer. The capture buffer is requeued after both
+   Pre() and the YUYV to BGRA conversion of the Image Thread finish reading it.
+   Pre() reads the buffer at the physical address returned by Camera::capture_image().
+   The inference side is zero-copy only with DRPAI_INPUT_PADDING = 0. With DRPAI_INPUT_PADDING = 1 (default),
+   the image is still copied to the DRP-AI input buffer for every inference: the padding rows of the
+   CAM_IMAGE_WIDTH x CAM_IMAGE_WIDTH input must follow the image in memory, the capture buffer has no room for them,
+   and the pre-processing parameters (s_preproc_param_t) can crop and resize the input but cannot pad it.
+   n = 0: Disable
+   n = 1: Enable
+   */
+#define CAPTURE_ZERO_COPY_MODE      (0)
+
 /* Padding input mode to maintain the aspect ratio of DRP-AI input image.
    This mode requires the DRP-AI object file having the squared input size CAM_IMAGE_WIDTH x CAM_IMAGE_WIDTH.
    0: No padding, 
    1: With padding (maintains the aspect ratio) */
 #define DRPAI_INPUT_PADDING         (1)
+#if ((1) == CAPTURE_ZERO_COPY_MODE) && ((1) == DRPAI_INPUT_PADDING)
+#warning "CAPTURE_ZERO_COPY_MODE: the DRP-AI input is still copied with DRPAI_INPUT_PADDING = 1"
+#endif
 
 #if(1)  // TVM
 /* DRP-AI memory offset for model object file*/
@@ -112,6 +206,10 @@ const static uint32_t num_grid_points = num_grids[0] * num_grids[0] + num_grids[
                                 
 #define TH_PROB                     (0.5f)
 #define TH_NMS                      (0.5f)
+/* Max number of boxes given to NMS. Boxes with lower probability are dropped before NMS. */
+#define NMS_TOP_K                   (300)
+/* Size of the spatial bins of NMS in pixels of the box coordinates */
+#define NMS_BIN_SIZE                (64)
 /* Size of input image to the model */
 #define MODEL_IN_W                  (640)
 #define MODEL_IN_H                  (640)
@@ -177,7 +275,12 @@ const static std::string output_path = "output.png";
 #endif
 
 #define IMAGE_CHANNEL_BGRA          (4)
-#define WL_BUF_NUM                  (2)
+/* Number of display buffers, which are the slots of the frame ring (frame_ring.h).
+   3 slots let the Capture, Image and Display Threads hold one frame each. */
+#define WL_BUF_NUM                  (3)
+/* Number of slots of the output queue (output_queue.h) between the AI Inference Thread and
+   the Post-processing Thread. 2 slots let DRP-AI run the next frame during the post-processing. */
+#define AI_OUTPUT_BUF_NUM           (2)
 
 /*Image:: Text information to be drawn on image*/
 #define CHAR_SCALE_LARGE            (0.8)
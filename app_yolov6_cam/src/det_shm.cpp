@@ -0,0 +1,320 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : det_shm.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for metiuan Detection YOLOv6 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "det_shm.h"
+#include <algorithm>
+#include <cstddef>
+
+/* The counters are shared between processes. */
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "seq must be lock-free");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "num_published must be lock-free");
+
+/* Times a reader retries when the record is updated during the copy */
+#define DET_SHM_READ_RETRY          (16)
+
+DetPublisher::DetPublisher()
+{
+    map_addr = NULL;
+    map_size = 0;
+    header = NULL;
+    records = NULL;
+    current = NULL;
+}
+
+DetPublisher::~DetPublisher()
+{
+    close();
+}
+
+/*****************************************
+* Function Name : open
+* Description   : Create the detection shared memory.
+*                 The shared memory left by a terminated application is replaced.
+* Arguments     : shm_name = name of the POSIX shared memory (e.g. "/app_det")
+*                 num_slot = number of the records
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t DetPublisher::open(const std::string& shm_name, uint32_t num_slot)
+{
+    int32_t fd = -1;
+    void* addr = NULL;
+    uint64_t size = sizeof(det_shm_header) + (uint64_t)num_slot * sizeof(det_shm_record);
+
+    close();
+    if (0 == num_slot)
+    {
+        fprintf(stderr, "[ERROR] Invalid detection shared memory setting : %u slots\n", num_slot);
+        return -1;
+    }
+    shm_unlink(shm_name.c_str());
+    errno = 0;
+    fd = shm_open(shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (0 > fd)
+    {
+        fprintf(stderr, "[ERROR] Failed to create the detection shared memory : %s errno=%d\n", shm_name.c_str(), errno);
+        return -1;
+    }
+    /* The new memory is filled with 0: all sequence counters are even (no record is being written). */
+    if (0 != ftruncate(fd, size))
+    {
+        fprintf(stderr, "[ERROR] Failed to allocate the detection shared memory : errno=%d\n", errno);
+        ::close(fd);
+        shm_unlink(shm_name.c_str());
+        return -1;
+    }
+    addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (MAP_FAILED == addr)
+    {
+        fprintf(stderr, "[ERROR] Failed to map the detection shared memory : errno=%d\n", errno);
+        shm_unlink(shm_name.c_str());
+        return -1;
+    }
+    name = shm_name;
+    map_addr = (uint8_t*)addr;
+    map_size = size;
+    header = (det_shm_header*)map_addr;
+    records = (det_shm_record*)(map_addr + sizeof(det_shm_header));
+
+    header->version = DET_SHM_VERSION;
+    header->slot_num = num_slot;
+    header->max_box = DET_SHM_MAX_BOX;
+    header->record_size = sizeof(det_shm_record);
+    header->writer_pid.store(getpid());
+    header->num_published.store(0);
+    /* Readers check the magic before the other fields. */
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(header->magic, DET_SHM_MAGIC, sizeof(header->magic));
+    return 0;
+}
+
+/*****************************************
+* Function Name : close
+* Description   : Unmap and remove the detection shared memory.
+*                 The readers which have mapped it can still read the last records.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void DetPublisher::close()
+{
+    if (NULL != map_addr)
+    {
+        header->writer_pid.store(0);
+        munmap(map_addr, map_size);
+        shm_unlink(name.c_str());
+    }
+    map_addr = NULL;
+    map_size = 0;
+    header = NULL;
+    records = NULL;
+    current = NULL;
+}
+
+/*****************************************
+* Function Name : begin
+* Description   : Start to write the next record. The readers retry or skip the record until commit().
+* Arguments     : -
+* Return value  : frame to be written, NULL if not opened
+******************************************/
+det_shm_frame* DetPublisher::begin()
+{
+    uint64_t index = 0;
+
+    if (NULL == header)
+    {
+        return NULL;
+    }
+    index = header->num_published.load(std::memory_order_relaxed);
+    current = &records[index % header->slot_num];
+    current->seq.store(current->seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    /* The odd counter is visible before any write to the frame. */
+    std::atomic_thread_fence(std::memory_order_release);
+    return &current->frame;
+}
+
+/*****************************************
+* Function Name : commit
+* Description   : Publish the record written after begin().
+* Arguments     : -
+* Return value  : -
+******************************************/
+void DetPublisher::commit()
+{
+    if (NULL == current)
+    {
+        return;
+    }
+    current->seq.store(current->seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    header->num_published.store(header->num_published.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    current = NULL;
+}
+
+DetSubscriber::DetSubscriber()
+{
+    map_addr = NULL;
+    map_size = 0;
+    header = NULL;
+    records = NULL;
+}
+
+DetSubscriber::~DetSubscriber()
+{
+    close();
+}
+
+/*****************************************
+* Function Name : open
+* Description   : Map the detection shared memory read-only.
+* Arguments     : shm_name = name of the POSIX shared memory
+* Return value  : 0 if succeeded
+*                 not 0 otherwise (e.g. the application is not running)
+******************************************/
+int8_t DetSubscriber::open(const std::string& shm_name)
+{
+    int32_t fd = -1;
+    struct stat st;
+    void* addr = NULL;
+
+    close();
+    errno = 0;
+    fd = shm_open(shm_name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (0 > fd)
+    {
+        fprintf(stderr, "[ERROR] Failed to open the detection shared memory : %s errno=%d\n", shm_name.c_str(), errno);
+        return -1;
+    }
+    if ((0 != fstat(fd, &st)) || ((uint64_t)st.st_size < sizeof(det_shm_header)))
+    {
+        fprintf(stderr, "[ERROR] Invalid detection shared memory : %s\n", shm_name.c_str());
+        ::close(fd);
+        return -1;
+    }
+    addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (MAP_FAILED == addr)
+    {
+        fprintf(stderr, "[ERROR] Failed to map the detection shared memory : errno=%d\n", errno);
+        return -1;
+    }
+    map_addr = (uint8_t*)addr;
+    map_size = st.st_size;
+    header = (const det_shm_header*)map_addr;
+
+    if ((0 != memcmp(header->magic, DET_SHM_MAGIC, sizeof(header->magic))))
+    {
+        fprintf(stderr, "[ERROR] Detection shared memory is not ready : %s\n", shm_name.c_str());
+        close();
+        return -1;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if ((DET_SHM_VERSION != header->version)
+        || (DET_SHM_MAX_BOX != header->max_box)
+        || (sizeof(det_shm_record) != header->record_size)
+        || (0 == header->slot_num)
+        || (sizeof(det_shm_header) + (uint64_t)header->slot_num * header->record_size > map_size))
+    {
+        fprintf(stderr, "[ERROR] Invalid detection shared memory header : %s\n", shm_name.c_str());
+        close();
+        return -1;
+    }
+    records = (const det_shm_record*)(map_addr + sizeof(det_shm_header));
+    return 0;
+}
+
+/*****************************************
+* Function Name : close
+* Description   : Unmap the detection shared memory.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void DetSubscriber::close()
+{
+    if (NULL != map_addr)
+    {
+        munmap(map_addr, map_size);
+    }
+    map_addr = NULL;
+    map_size = 0;
+    header = NULL;
+    records = NULL;
+}
+
+/*****************************************
+* Function Name : get_num_published
+* Description   : Get the number of the published frames. The newest frame is (number - 1).
+* Arguments     : -
+* Return value  : number of the frames
+******************************************/
+uint64_t DetSubscriber::get_num_published()
+{
+    return (NULL == header) ? 0 : header->num_published.load(std::memory_order_acquire);
+}
+
+/*****************************************
+* Function Name : read
+* Description   : Copy the published frame without a lock.
+*                 The copy is retried if the writer starts to overwrite the record during the copy.
+* Arguments     : index = index of the frame (0 to get_num_published() - 1)
+*                 frame = destination of the copy
+* Return value  : 0 if succeeded
+*                 not 0 if the frame is not published yet or already overwritten by a later frame
+******************************************/
+int8_t DetSubscriber::read(uint64_t index, det_shm_frame* frame)
+{
+    const det_shm_record* record = NULL;
+    /* Counter of the record after the frame is committed: each frame adds 2. */
+    uint32_t expected = 0;
+    uint32_t seq0 = 0;
+    uint32_t seq1 = 0;
+    uint32_t num_box = 0;
+    int32_t retry = 0;
+
+    if ((NULL == header) || (index >= get_num_published()))
+    {
+        return -1;
+    }
+    record = &records[index % header->slot_num];
+    expected = (uint32_t)(2 * (index / header->slot_num + 1));
+    for (retry = 0; retry < DET_SHM_READ_RETRY; retry++)
+    {
+        seq0 = record->seq.load(std::memory_order_acquire);
+        if (seq0 != expected)
+        {
+            /* A later frame is written or being written to the record. */
+            return -1;
+        }
+        memcpy(frame, &record->frame, offsetof(det_shm_frame, boxes));
+        num_box = std::min(frame->num_box, (uint32_t)DET_SHM_MAX_BOX);
+        memcpy(frame->boxes, record->frame.boxes, num_box * sizeof(det_shm_box));
+        /* The copy is done before the counter is checked again. */
+        std::atomic_thread_fence(std::memory_order_acquire);
+        seq1 = record->seq.load(std::memory_order_relaxed);
+        if (seq0 == seq1)
+        {
+            frame->num_box = num_box;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/*****************************************
+* Function Name : get_writer_pid
+* Description   : Get the process ID of the application.
+* Arguments     : -
+* Return value  : process ID, 0 if the application has terminated
+******************************************/
+int32_t DetSubscriber::get_writer_pid()
+{
+    return (NULL == header) ? 0 : header->writer_pid.load();
+}
@@ -11,7 +11,7 @@
 * Includes
 ******************************************/
 #include "dfl_proc_yolov6.h"
-#include <opencv2/opencv.hpp>
+#include <algorithm>
 #include <thread>
 
 using namespace std;
@@ -0,0 +1,40 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : event.h
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for metiuan Detection YOLOv6 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+#ifndef EVENT_H
+#define EVENT_H
+
+#include "define.h"
+
+/* Return values of Event::wait */
+#define EVENT_SIGNALED              (0)
+#define EVENT_TERMINATED            (1)
+#define EVENT_TIMEOUT               (2)
+#define EVENT_ERROR                 (-1)
+
+/* Wakes up a waiting thread through an eventfd.
+   Each event has one waiting thread. wait() returns also when the terminate event
+   is signaled, which is never cleared, so that all threads see the termination. */
+class Event
+{
+    public:
+        Event();
+        ~Event();
+
+        int8_t init();
+        void close();
+        void signal();
+        int8_t wait(Event& terminate, int32_t timeout);
+        static int8_t wait_fd(int32_t fd, Event& terminate, int32_t timeout);
+
+    private:
+        int32_t fd = -1;
+};
+
+#endif
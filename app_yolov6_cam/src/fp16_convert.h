@@ -0,0 +1,46 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : fp16_convert.h
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for metiuan Detection YOLOv6 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+#ifndef FP16_CONVERT_H
+#define FP16_CONVERT_H
+
+#include "define.h"
+
+/*****************************************
+* Function Name     : float16_to_float32
+* Description       : Cast uint16_t a (IEEE 754 half precision) into float value.
+*                     The exponent is rebased by a float multiply with 2^112,
+*                     which also normalizes the subnormal numbers, so no branch is needed
+*                     except for Inf/NaN.
+* Arguments         : a = uint16_t number
+* Return value      : float = float32 number
+******************************************/
+inline float float16_to_float32(uint16_t a)
+{
+    const uint32_t magic_bits = 0x77800000u; /* 2^112 */
+    uint32_t exp_mant = ((uint32_t)a & 0x7FFFu) << 13;
+    uint32_t bits = 0;
+    float magic = 0;
+    float f = 0;
+
+    memcpy(&magic, &magic_bits, sizeof(float));
+    memcpy(&f, &exp_mant, sizeof(float));
+    f *= magic;
+    memcpy(&bits, &f, sizeof(float));
+    /* Inf/NaN */
+    bits |= (exp_mant >= 0x0F800000u) ? 0x7F800000u : 0;
+    /* Sign */
+    bits |= ((uint32_t)a & 0x8000u) << 16;
+    memcpy(&f, &bits, sizeof(float));
+    return f;
+}
+
+void float16_to_float32_array(const uint16_t* src, float* dst, int64_t num);
+
+#endif
@@ -0,0 +1,137 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : frame_trace.h
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for metiuan Detection YOLOv6 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+#ifndef FRAME_TRACE_H
+#define FRAME_TRACE_H
+
+#include "define.h"
+#include <time.h>
+#include <memory>
+
+/* Stages of a frame recorded by the trace points */
+enum trace_stage : uint32_t
+{
+    TRACE_CAPTURE = 0,      /* Capture Thread: hand over of the captured frame */
+    TRACE_DRP_COPY,         /* Capture Thread: copy to the DRP-AI input buffer */
+    TRACE_PRE,              /* AI Inference Thread: Pre() */
+    TRACE_RUN,              /* AI Inference Thread: Run() */
+    TRACE_DFL,              /* Post-processing Thread: DFL */
+    TRACE_DECODE,           /* Post-processing Thread: decode */
+    TRACE_NMS,              /* Post-processing Thread: NMS */
+    TRACE_CONVERT,          /* Image Thread: YUYV to BGRA conversion */
+    TRACE_DRAW,             /* Image Thread: drawing of the AI result */
+    TRACE_COMMIT,           /* Display Thread: Wayland commit */
+    TRACE_FRAME,            /* capture_image() return to Wayland commit of a displayed frame */
+    TRACE_STAGE_NUM
+};
+
+/* Frame ID is not available */
+#define TRACE_NO_FRAME              (UINT64_MAX)
+
+/* One trace event. The fields are atomic so that the ring can be exported while it is written.
+   seq is written last and checked before and after reading the other fields. */
+typedef struct trace_event
+{
+    std::atomic<uint64_t> seq;      /* index of the event in the thread + 1, 0: not written yet */
+    std::atomic<uint32_t> stage;    /* trace_stage */
+    std::atomic<uint64_t> frame;    /* capture frame ID */
+    std::atomic<uint64_t> ref;      /* related frame ID (AI frame of the drawn result) */
+    std::atomic<uint64_t> start;    /* CLOCK_MONOTONIC [ns] */
+    std::atomic<uint64_t> end;      /* CLOCK_MONOTONIC [ns] */
+} trace_event_t;
+
+/* Ring of the trace events written by one thread */
+typedef struct trace_thread
+{
+    char name[32];
+    int32_t tid;
+    std::unique_ptr<trace_event_t[]> events;
+    std::atomic<uint64_t> count;
+    std::atomic<uint8_t> ready;
+} trace_thread_t;
+
+/* Per-frame trace of the pipeline. Each thread writes its own ring without lock,
+   and export_json writes the rings as Chrome/Perfetto trace JSON.
+   The trace points are compiled out when FRAME_TRACE_MODE is 0. */
+class FrameTrace
+{
+    public:
+        FrameTrace();
+        ~FrameTrace();
+
+        void register_thread(const char* name);
+        int8_t export_json(const char* path);
+
+        /*****************************************
+        * Function Name : now
+        * Description   : Get the timestamp of the trace point.
+        * Arguments     : -
+        * Return value  : CLOCK_MONOTONIC [ns], 0 if FRAME_TRACE_MODE is 0
+        ******************************************/
+        static inline uint64_t now()
+        {
+#if (1) == FRAME_TRACE_MODE
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+            return 0;
+#endif
+        }
+
+        /*****************************************
+        * Function Name : record
+        * Description   : Record the stage of the frame from start to now.
+        * Arguments     : stage = trace_stage
+        *                 frame = capture frame ID
+        *                 start = timestamp of the start given by now()
+        *                 ref = related frame ID
+        * Return value  : -
+        ******************************************/
+        inline void record(uint32_t stage, uint64_t frame, uint64_t start, uint64_t ref = TRACE_NO_FRAME)
+        {
+#if (1) == FRAME_TRACE_MODE
+            record_event(stage, frame, start, now(), ref);
+#else
+            (void)stage;
+            (void)frame;
+            (void)start;
+            (void)ref;
+#endif
+        }
+
+        /*****************************************
+        * Function Name : record_span
+        * Description   : Record the stage of the frame from start to end.
+        * Arguments     : stage = trace_stage
+        *                 frame = capture frame ID
+        *                 start = timestamp of the start given by now()
+        *                 end = timestamp of the end given by now()
+        * Return value  : -
+        ******************************************/
+        inline void record_span(uint32_t stage, uint64_t frame, uint64_t start, uint64_t end)
+        {
+#if (1) == FRAME_TRACE_MODE
+            record_event(stage, frame, start, end, TRACE_NO_FRAME);
+#else
+            (void)stage;
+            (void)frame;
+            (void)start;
+            (void)end;
+#endif
+        }
+
+    private:
+        trace_thread_t threads[FRAME_TRACE_MAX_THREAD];
+        std::atomic<int32_t> num_thread;
+
+        void record_event(uint32_t stage, uint64_t frame, uint64_t start, uint64_t end, uint64_t ref);
+};
+
+#endif
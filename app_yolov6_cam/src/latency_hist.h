@@ -0,0 +1,132 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : latency_hist.h
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for metiuan Detection YOLOv6 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include "define.h"
+#include <time.h>
+
+/* Log-linear buckets: values below 2^(SUB_BITS + 1) [ns] have their own bucket,
+   and each power of two above is split into 2^SUB_BITS buckets (relative error < 1/2^SUB_BITS). */
+#define LATENCY_HIST_SUB_BITS       (5)
+/* Values of 2^MAX_BITS [ns] (68.7 s) or more are counted in the last bucket. */
+#define LATENCY_HIST_MAX_BITS       (36)
+#define LATENCY_HIST_BUCKET_NUM     ((LATENCY_HIST_MAX_BITS - LATENCY_HIST_SUB_BITS + 1) << LATENCY_HIST_SUB_BITS)
+
+/* Stages measured by the latency histograms */
+enum latency_stage : uint32_t
+{
+    LATENCY_CAPTURE = 0,    /* interval between two captured frames */
+    LATENCY_COPY,           /* copy to the DRP-AI input buffer */
+    LATENCY_PRE,            /* Pre() */
+    LATENCY_RUN,            /* Run() */
+    LATENCY_FP16,           /* set_outputs: binding and FP16 to FP32 conversion of the outputs */
+    LATENCY_DFL,            /* DFL */
+    LATENCY_ARGMAX,         /* max class score of the grid points (in decode) */
+    LATENCY_DECODE,         /* decode */
+    LATENCY_NMS,            /* NMS */
+    LATENCY_CONVERT,        /* YUYV to BGRA conversion */
+    LATENCY_DRAW,           /* drawing of the AI result */
+    LATENCY_COMMIT,         /* Wayland commit */
+    LATENCY_FRAME,          /* capture to Wayland commit of a displayed frame */
+    LATENCY_STAGE_NUM
+};
+
+/* Copy of a histogram taken by LatencyHist::snapshot */
+typedef struct latency_snapshot
+{
+    uint32_t counts[LATENCY_HIST_BUCKET_NUM];
+    uint64_t count;             /* number of values */
+    uint64_t sum;               /* sum of the values [ns] */
+    uint64_t min;               /* [ns], 0 if count is 0 */
+    uint64_t max;               /* [ns] */
+} latency_snapshot_t;
+
+/* Fixed memory histogram of latencies in nanoseconds.
+   record is lock-free and may be called by any thread while another thread takes a snapshot. */
+class LatencyHist
+{
+    public:
+        LatencyHist();
+        ~LatencyHist();
+
+        void snapshot(latency_snapshot_t* snap, bool reset);
+        static uint64_t percentile(const latency_snapshot_t* snap, double p);
+        static const char* get_stage_name(uint32_t stage);
+
+        /*****************************************
+        * Function Name : now
+        * Description   : Get the timestamp to measure the latency.
+        * Arguments     : -
+        * Return value  : CLOCK_MONOTONIC [ns]
+        ******************************************/
+        static inline uint64_t now()
+        {
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+        }
+
+        /*****************************************
+        * Function Name : record
+        * Description   : Count the latency in its bucket.
+        * Arguments     : ns = latency [ns]
+        * Return value  : -
+        ******************************************/
+        inline void record(uint64_t ns)
+        {
+            uint64_t m = max.load(std::memory_order_relaxed);
+
+            counts[get_index(ns)].fetch_add(1, std::memory_order_relaxed);
+            count.fetch_add(1, std::memory_order_relaxed);
+            sum.fetch_add(ns, std::memory_order_relaxed);
+            while ((ns > m) && !max.compare_exchange_weak(m, ns, std::memory_order_relaxed))
+            {
+            }
+            m = min.load(std::memory_order_relaxed);
+            while ((ns < m) && !min.compare_exchange_weak(m, ns, std::memory_order_relaxed))
+            {
+            }
+        }
+
+    private:
+        std::atomic<uint32_t> counts[LATENCY_HIST_BUCKET_NUM];
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> sum;
+        std::atomic<uint64_t> min;
+        std::atomic<uint64_t> max;
+
+        /*****************************************
+        * Function Name : get_index
+        * Description   : Get the bucket of the value.
+        * Arguments     : ns = latency [ns]
+        * Return value  : bucket index
+        ******************************************/
+        static inline uint32_t get_index(uint64_t ns)
+        {
+            uint32_t msb;
+            uint32_t shift;
+
+            if (ns < ((uint64_t)1 << (LATENCY_HIST_SUB_BITS + 1)))
+            {
+                return (uint32_t)ns;
+            }
+            if (ns >= ((uint64_t)1 << LATENCY_HIST_MAX_BITS))
+            {
+                return LATENCY_HIST_BUCKET_NUM - 1;
+            }
+            msb = 63 - __builtin_clzll(ns);
+            shift = msb - LATENCY_HIST_SUB_BITS;
+            return ((shift + 1) << LATENCY_HIST_SUB_BITS) + (uint32_t)(ns >> shift) - (1 << LATENCY_HIST_SUB_BITS);
+        }
+        static uint64_t get_upper(uint32_t index);
+};
+
+#endif
@@ -20,18 +20,30 @@
 /*Definition of Macros & other variables*/
 #include "define.h"
 #include "define_color_yolov6.h"
-/*DFL process control*/
-#include "dfl_proc_yolov6.h"
+/*CPU post-processing*/
+#include "post_proc.h"
+/*DRP-AI output record*/
+#include "tensor_record.h"
 /*USB camera control*/
 #include "camera.h"
 /*Image control*/
 #include "image_yolov6.h"
+#include "frame_ring.h"
+#include "event.h"
+#include "output_queue.h"
+#include "capture_share.h"
+#include "frame_trace.h"
+#include "latency_hist.h"
+#include "metrics_server.h"
+#include "det_log.h"
+#include "det_shm.h"
 /*Wayland control*/
 #include "wayland.h"
 /*box drawing*/
 #include "box.h"
 /*Mutual exclusion*/
 #include <mutex>
+#include <signal.h>
 #include "spdlog/spdlog.h"
 #include "spdlog/sinks/basic_file_sink.h"
 #include <opencv2/opencv.hpp>
@@ -42,30 +54,84 @@ using namespace std;
 ******************************************/
 /*Multithreading*/
 static sem_t terminate_req_sem;
+/* Wakes up the threads instead of polling */
+static Event terminate_event;   /* termination is requested */
+static Event inference_event;   /* Capture Thread -> AI Inference Thread: input image is ready */
+static Event capture_event;     /* Capture Thread -> Image Thread: frame is captured */
+static Event convert_event;     /* Image Thread -> Display Thread: frame is converted */
+#if (1) == FRAME_TRACE_MODE
+static Event trace_request_event;   /* SIGUSR1 -> Main Process: export the frame trace */
+#endif
 static pthread_t ai_inf_thread;
+static pthread_t post_thread;
 static pthread_t kbhit_thread;
 static pthread_t capture_thread;
 static pthread_t img_thread;
 static pthread_t hdmi_thread;
+#if (1) == METRICS_MODE
+static pthread_t metrics_thread;
+#endif
 static mutex mtx;
 
 /*Flags*/
 static atomic<uint8_t> inference_start (0);
-static atomic<uint8_t> img_obj_ready   (0);
-static atomic<uint8_t> hdmi_obj_ready   (0);
+#if (1) == CAPTURE_ZERO_COPY_MODE
+/* V4L2 capture buffer shared by AI Inference Thread and Image Thread */
+static CaptureShare capture_share;
+#endif
+#if (1) == DISP_OVERLAY_MODE
+/* Incremented when the AI result is updated */
+static atomic<uint32_t> result_cnt      (0);
+/* Set when the overlay is redrawn and cleared when it is committed */
+static atomic<uint8_t> overlay_ready    (0);
+#endif
 
 /*Global Variables*/
-static float output_dfl80[num_dfl80_out];
-static float output_dfl40[num_dfl40_out];
-static float output_dfl20[num_dfl20_out];
-static float output_class80[num_class80_out];
-static float output_class40[num_class40_out];
-static float output_class20[num_class20_out];
-static float drpai_output_buf[num_inf_out];
+/* DRP-AI outputs of the current frame */
+static vector<std::tuple<InOutDataType, void*, int64_t>> drpai_outputs;
 static uint64_t capture_address;
-static uint8_t buf_id;
+#if (1) == DISP_OVERLAY_MODE
+static uint8_t overlay_id;
+#endif
 static Image img;
-static DFL dfl;
+/* Headless mode ("--headless"): Image and Display Threads are not created,
+   and the captured frames go only to the inference. */
+static bool headless = false;
+/* Handoff of the display buffers between Capture, Image and Display Threads */
+static FrameRing frame_ring;
+static PostProc post_proc;
+/* DRP-AI outputs handed over from AI Inference Thread to Post-processing Thread */
+static OutputQueue output_queue;
+/* Per-frame trace of the pipeline */
+static FrameTrace frame_trace;
+/* Latency histogram of each pipeline stage */
+static LatencyHist latency_hist[LATENCY_STAGE_NUM];
+/* Unix domain socket of the metrics snapshot */
+static MetricsServer metrics_server;
+/* Counters for the metrics snapshot */
+static atomic<uint64_t> num_captured_frame (0);     /* frames captured after the camera is stabilized */
+static atomic<uint32_t> num_candidate (0);          /* boxes over the threshold before NMS in the last frame */
+static atomic<uint32_t> num_detection (0);          /* boxes after NMS in the last frame */
+static atomic<uint64_t> num_candidate_total (0);
+static atomic<uint64_t> num_detection_total (0);
+/* Capture frame ID and capture time (CLOCK_REALTIME) of the image given to the inference */
+static uint64_t inference_frame_id = 0;
+static struct timespec inference_capture_time;
+/* Capture frame ID and capture time of the frame in each display buffer */
+static uint64_t display_frame_id[WL_BUF_NUM];
+static uint64_t display_capture_time[WL_BUF_NUM];
+/* Capture frame ID of the AI result in det (guarded by mtx), and of the result drawn last */
+static uint64_t det_frame_id = TRACE_NO_FRAME;
+static uint64_t drawn_frame_id = TRACE_NO_FRAME;
+#if (1) == DET_LOG_MODE
+static DetLogger det_logger;
+#endif
+#if (1) == DET_SHM_MODE
+static DetPublisher det_publisher;
+#endif
+#if (1) == TENSOR_RECORD_MODE
+static TensorRecorder tensor_recorder;
+#endif
 
 /*AI Inference for DRPAI*/
 /* DRP-AI TVM[*1] Runtime object */
@@ -96,17 +162,6 @@ static double pre_time = 0;
 static double post_time = 0;
 static double ai_time = 0;
 
-/*****************************************
-* Function Name     : float16_to_float32
-* Description       : Function by Edgecortex. Cast uint16_t a into float value.
-* Arguments         : a = uint16_t number
-* Return value      : float = float32 number
-******************************************/
-float float16_to_float32(uint16_t a)
-{
-    return __extendXfYf2__<uint16_t, uint16_t, 10, float, uint32_t, 23>(a);
-}
-
 /*****************************************
 * Function Name : timedifference_msec
 * Description   : compute the time differences in ms between two moments
@@ -140,176 +195,232 @@ static int8_t wait_join(pthread_t *p_join_thread, uint32_t join_time)
     return ret_err;
 }
 
+/*****************************************
+* Function Name : request_terminate
+* Description   : Request all threads to terminate.
+*                 Set the Termination Request Semaphore to 0 and wake up the waiting threads.
+* Arguments     : -
+* Return value  : -
+******************************************/
+static void request_terminate(void)
+{
+    sem_trywait(&terminate_req_sem);
+    terminate_event.signal();
+}
+
+/*****************************************
+* Function Name : init_events
+* Description   : Create the events to wake up the threads.
+* Arguments     : -
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+static int8_t init_events(void)
+{
+    if ((0 != terminate_event.init()) || (0 != inference_event.init())
+        || (0 != capture_event.init()) || (0 != convert_event.init()))
+    {
+        return -1;
+    }
+#if (1) == CAPTURE_ZERO_COPY_MODE
+    if (0 != capture_share.init())
+    {
+        return -1;
+    }
+#endif
+#if (1) == FRAME_TRACE_MODE
+    if (0 != trace_request_event.init())
+    {
+        return -1;
+    }
+#endif
+    return 0;
+}
+
+#if (1) == FRAME_TRACE_MODE
+/*****************************************
+* Function Name : trace_signal_handler
+* Description   : SIGUSR1 handler to request the export of the frame trace.
+*                 Only wakes up the Main Process, since eventfd write is async-signal-safe.
+* Arguments     : sig = signal number
+* Return value  : -
+******************************************/
+static void trace_signal_handler(int32_t sig)
+{
+    (void)sig;
+    trace_request_event.signal();
+}
+
+#endif
 /*****************************************
 * Function Name : get_result
-* Description   : Get DRP-AI Output from memory via DRP-AI Driver
+* Description   : Get the DRP-AI outputs of the current frame into drpai_outputs.
+*                 The outputs are copied to the output queue and then to the buffers
+*                 of the post-processing in Post-processing Thread.
 * Arguments     : -
 * Return value  : 0 if succeeded
 *                 not 0 otherwise
 ******************************************/
 int8_t get_result()
 {
-    int8_t ret = 0;
     int32_t i = 0;
     int32_t output_num = 0;
-    std::tuple<InOutDataType, void*, int64_t> output_buffer;
-    int64_t output_size;
 
     /* Get the number of output of the target model. */
     output_num = runtime.GetNumOutput();
+    drpai_outputs.clear();
     /*GetOutput loop*/
     for (i = 0;i<output_num;i++)
     {
         /* output_buffer below is tuple, which is { data type, address of output data, number of elements } */
-        output_buffer = runtime.GetOutput(i);
-        /*Output Data Size = std::get<2>(output_buffer). */
-        output_size = std::get<2>(output_buffer);
+        drpai_outputs.push_back(runtime.GetOutput(i));
+    }
+    return 0;
+}
 
-        /*Output Data Type = std::get<0>(output_buffer)*/
-        if (InOutDataType::FLOAT16 == std::get<0>(output_buffer))
-        {
-            /*Output Data = std::get<1>(output_buffer)*/
-            uint16_t* data_ptr = reinterpret_cast<uint16_t*>(std::get<1>(output_buffer));
+#if (1) == TENSOR_RECORD_MODE
+/*****************************************
+* Function Name : start_tensor_record
+* Description   : Create the tensor record file with the data types and shapes of the DRP-AI outputs.
+* Arguments     : -
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t start_tensor_record(void)
+{
+    int8_t ret = 0;
+    int32_t shapes[TENSOR_RECORD_MAX_OUTPUT][4];
+    int64_t output_size;
 
-            for (int j = 0; j<output_size; j++)
-            {
-                /*FP16 to FP32 conversion*/
-                switch (output_size)
-                {
-                    case num_dfl80_out:
-                        output_dfl80[j]=float16_to_float32(data_ptr[j]);
-                        break;
-                    case num_dfl40_out:
-                        output_dfl40[j]=float16_to_float32(data_ptr[j]);
-                        break;
-                    case num_dfl20_out:
-                        output_dfl20[j]=float16_to_float32(data_ptr[j]);
-                        break;
-                    case num_class80_out:
-                        output_class80[j]=float16_to_float32(data_ptr[j]);
-                        break;
-                    case num_class40_out:
-                        output_class40[j]=float16_to_float32(data_ptr[j]);
-                        break;
-                    case num_class20_out:
-                        output_class20[j]=float16_to_float32(data_ptr[j]);
-                        break;
-                    default:
-                        break;
-                }
-            }
-        }
-        else if (InOutDataType::FLOAT32 == std::get<0>(output_buffer))
-        {
-            /*Output Data = std::get<1>(output_buffer)*/
-            float* data_ptr = reinterpret_cast<float*>(std::get<1>(output_buffer));
-            for (int j = 0; j<output_size; j++)
-            {
-                switch (output_size)
-                {
-                    case num_dfl80_out:
-                        output_dfl80[j]=data_ptr[j];
-                        break;
-                    case num_dfl40_out:
-                        output_dfl40[j]=data_ptr[j];
-                        break;
-                    case num_dfl20_out:
-                        output_dfl20[j]=data_ptr[j];
-                        break;
-                    case num_class80_out:
-                        output_class80[j]=data_ptr[j];
-                        break;
-                    case num_class40_out:
-                        output_class40[j]=data_ptr[j];
-                        break;
-                    case num_class20_out:
-                        output_class20[j]=data_ptr[j];
-                        break;
-                    default:
-                        break;
-                }
-            }
-        }
-        else
+    /* Copy the outputs once to check the data types. The output data is not used. */
+    ret = get_result();
+    if (0 == ret)
+    {
+        ret = post_proc.set_outputs(drpai_outputs.data(), drpai_outputs.size());
+    }
+    if (0 != ret)
+    {
+        return ret;
+    }
+    if (TENSOR_RECORD_MAX_OUTPUT < drpai_outputs.size())
+    {
+        fprintf(stderr, "[ERROR] Too many outputs for the tensor record : %zu\n", drpai_outputs.size());
+        return -1;
+    }
+    for (size_t i = 0; i < drpai_outputs.size(); i++)
+    {
+        output_size = std::get<2>(drpai_outputs[i]);
+        if (0 != post_proc.get_shape(output_size, shapes[i]))
         {
-            fprintf(stderr, "[ERROR] Output data type : not floating point.\n");
-            ret = -1;
-            break;
+            shapes[i][0] = 1;
+            shapes[i][1] = (int32_t)output_size;
+            shapes[i][2] = 1;
+            shapes[i][3] = 1;
         }
     }
+    ret = tensor_recorder.open(TENSOR_RECORD_FILE, drpai_outputs.data(), drpai_outputs.size(), shapes,
+        TENSOR_RECORD_RING_NUM, TENSOR_RECORD_MAX_FRAME);
+    if (0 == ret)
+    {
+        printf("Tensor Record : %s\n", TENSOR_RECORD_FILE);
+    }
     return ret;
 }
+#endif
 
 /*****************************************
-* Function Name : R_Post_Proc
-* Description   : Process CPU post-processing for Yolov6
-* Arguments     : floatarr = drpai output address
+* Function Name : record_stage
+* Description   : Record the stage from start to now in the latency histogram and in the frame trace.
+* Arguments     : stage = latency_stage
+*                 trace = trace_stage
+*                 frame_id = capture frame ID
+*                 start = timestamp of the start given by LatencyHist::now()
+* Return value  : timestamp of the end
+******************************************/
+static uint64_t record_stage(uint32_t stage, uint32_t trace, uint64_t frame_id, uint64_t start)
+{
+    uint64_t end = LatencyHist::now();
+
+    latency_hist[stage].record(end - start);
+    frame_trace.record_span(trace, frame_id, start, end);
+    return end;
+}
+
+#if (1) == DET_SHM_MODE
+/*****************************************
+* Function Name : publish_result
+* Description   : Publish the detections to the detection shared memory.
+*                 The boxes after DET_SHM_MAX_BOX are not published.
+* Arguments     : det_buff = detections after NMS in DRP-AI input size
+*                 slot = output slot of the detections
 * Return value  : -
 ******************************************/
-void R_Post_Proc(float* floatarr)
+static void publish_result(const vector<detection>& det_buff, const output_slot_t* slot)
 {
-    vector<detection> det_buff;
+    struct timespec publish_time;
+    det_shm_frame* frame = det_publisher.begin();
     uint32_t i = 0;
-    uint32_t j = 0;
-    float score = 0;
-    float probability = 0;
-    float center_x = 0;
-    float center_y = 0;
-    float box_w = 0;
-    float box_h = 0;
-    int32_t pred_class = -1;
-    detection d;
-
-    float predictions[num_grid_points][NUM_CLASS + 4];
-
-    /* Convert 2D array and Transpose */
-    for (j = 0; j < NUM_CLASS + 4; j++)
-    {
-        for (i = 0; i < num_grid_points; i++)
-        {
-            predictions[i][j] = floatarr[j * num_grid_points + i];
-        }
-    }
 
-    for (i = 0; i < num_grid_points; i++)
+    if (NULL == frame)
     {
-	float max_pred = 0;
-        for (j = 0; j < NUM_CLASS; j++)
-        {
-            score = predictions[i][j + 4];
-            if (score > max_pred)
-            {
-                pred_class = j;
-                max_pred = score;
-            }
-        }
-        probability = max_pred;
-        if (probability > TH_PROB)
-        {
-            float scale_x = (float)DRPAI_IN_WIDTH / (float)MODEL_IN_W;
-            float scale_y = (float)DRPAI_IN_HEIGHT / (float)MODEL_IN_H;
-
-
-            center_x = predictions[i][0] * scale_x;
-            center_y = predictions[i][1] * scale_y;
-            box_w = predictions[i][2] * scale_x;
-            box_h = predictions[i][3] * scale_y;
-
-            Box bb = {center_x, center_y, box_w, box_h};
-            d = {bb, pred_class, probability};
-            det_buff.push_back(d);
-        }
+        return;
     }
+    timespec_get(&publish_time, TIME_UTC);
+    frame->frame_id = slot->frame_id;
+    frame->frame_no = slot->frame_no;
+    frame->capture_time = (int64_t)slot->capture_time.tv_sec * 1000000000 + slot->capture_time.tv_nsec;
+    frame->publish_time = (int64_t)publish_time.tv_sec * 1000000000 + publish_time.tv_nsec;
+    frame->num_detection = det_buff.size();
+    frame->num_box = std::min((uint32_t)det_buff.size(), (uint32_t)DET_SHM_MAX_BOX);
+    for (i = 0; i < frame->num_box; i++)
+    {
+        frame->boxes[i].cls = det_buff[i].c;
+        frame->boxes[i].prob = det_buff[i].prob;
+        frame->boxes[i].x = det_buff[i].bbox.x;
+        frame->boxes[i].y = det_buff[i].bbox.y;
+        frame->boxes[i].w = det_buff[i].bbox.w;
+        frame->boxes[i].h = det_buff[i].bbox.h;
+    }
+    det_publisher.commit();
+}
+#endif
 
-    /* Non-Maximum Supression filter */
-    filter_boxes_nms(det_buff, det_buff.size(), TH_NMS);
+/*****************************************
+* Function Name : R_Post_Proc
+* Description   : Process CPU post-processing for Yolov6
+* Arguments     : slot = output slot holding the DRP-AI outputs
+* Return value  : -
+******************************************/
+void R_Post_Proc(const output_slot_t* slot)
+{
+    vector<detection> det_buff;
+    uint64_t frame_id = slot->frame_id;
+    uint32_t i = 0;
+    uint64_t stage_start = LatencyHist::now();
+
+    post_proc.dfl_proc();
+    stage_start = record_stage(LATENCY_DFL, TRACE_DFL, frame_id, stage_start);
+    post_proc.decode(det_buff);
+    stage_start = record_stage(LATENCY_DECODE, TRACE_DECODE, frame_id, stage_start);
+    num_candidate.store(det_buff.size(), std::memory_order_relaxed);
+    num_candidate_total.fetch_add(det_buff.size(), std::memory_order_relaxed);
+    post_proc.nms_proc(det_buff);
+    record_stage(LATENCY_NMS, TRACE_NMS, frame_id, stage_start);
+    num_detection.store(det_buff.size(), std::memory_order_relaxed);
+    num_detection_total.fetch_add(det_buff.size(), std::memory_order_relaxed);
 
     /* Log Output */
+#if (1) == DET_LOG_MODE
+    det_logger.begin_frame(det_buff.size());
+    for(i = 0; i < det_buff.size(); i++)
+    {
+        det_logger.push_box(frame_id, det_buff[i].c, det_buff[i].prob,
+            det_buff[i].bbox.x, det_buff[i].bbox.y, det_buff[i].bbox.w, det_buff[i].bbox.h);
+    }
+#else
     int iBoxCount=0;
     for(i = 0; i < det_buff.size(); i++)
     {
-        /* Skip the overlapped bounding boxes */
-        if (det_buff[i].prob == 0) continue;
         spdlog::info(" Bounding Box Number : {}",i+1);
         spdlog::info(" Bounding Box        : (X, Y, W, H) = ({}, {}, {}, {})", (int)det_buff[i].bbox.x, (int)det_buff[i].bbox.y, (int)det_buff[i].bbox.w, (int)det_buff[i].bbox.h);
         spdlog::info(" Detected Class      : {} (Class {})", label_file_map[det_buff[i].c].c_str(), det_buff[i].c);
@@ -317,12 +428,17 @@ void R_Post_Proc(float* floatarr)
         iBoxCount++;
     }
     spdlog::info(" Bounding Box Count  : {}", iBoxCount);
+#endif
 
     mtx.lock();
     /* Clear the detected result list */
     det.clear();
     copy(det_buff.begin(), det_buff.end(), back_inserter(det));
+    det_frame_id = frame_id;
     mtx.unlock();
+#if (1) == DET_SHM_MODE
+    publish_result(det_buff, slot);
+#endif
     return ;
 }
 
@@ -336,29 +452,23 @@ void R_Post_Proc(float* floatarr)
 void draw_bounding_box(void)
 {
     vector<detection> det_buff;
-    stringstream stream;
-    string result_str;
+    char value[16];
     size_t i = 0;
     uint32_t color=0;
  
     mtx.lock();
     copy(det.begin(), det.end(), back_inserter(det_buff));
+    drawn_frame_id = det_frame_id;
     mtx.unlock();
 
     /* Draw bounding box on RGB image. */
     for (i = 0; i < det_buff.size(); i++)
     {
-        /* Skip the overlapped bounding boxes */
-        if (det_buff[i].prob == 0) continue;
-        
         color = box_color[det_buff[i].c];
-        /* Clear string stream for bounding box labels */
-        stream.str("");
-        /* Draw the bounding box on the image */
-        stream << fixed << setprecision(2) << det_buff[i].prob;
-        result_str = label_file_map[det_buff[i].c]+ " "+ stream.str();
+        /* Only the probability is formatted, the class name is drawn from the sprite cache */
+        snprintf(value, sizeof(value), " %.2f", det_buff[i].prob);
         
-        img.draw_rect((int)det_buff[i].bbox.x, (int)det_buff[i].bbox.y, (int)det_buff[i].bbox.w, (int)det_buff[i].bbox.h, result_str.c_str(),color);
+        img.draw_rect((int)det_buff[i].bbox.x, (int)det_buff[i].bbox.y, (int)det_buff[i].bbox.w, (int)det_buff[i].bbox.h, label_file_map[det_buff[i].c].c_str(), value, color);
     }
     return;
 }
@@ -378,40 +488,30 @@ int8_t print_result(Image* img)
     start = chrono::system_clock::now();
 #endif // DEBUG_TIME_FLG
     vector<detection> det_buff;
-    stringstream stream;
-    string str = "";
+    char value[32];
     double total_time = ai_time + pre_time + post_time;
     
+    /* The labels are drawn from the sprite cache, so only the numbers are formatted every frame. */
     /* Draw Total Time Result on RGB image.*/
-    stream.str("");
-    stream << "Total AI Time : " << std::setw(3) << std::fixed << std::setprecision(1) << std::round(total_time * 10) / 10 << "msec";
-    str = stream.str();
-    img->write_string_rgb(str, 2, TEXT_WIDTH_OFFSET,  LINE_HEIGHT_OFFSET + (LINE_HEIGHT * 1), CHAR_SCALE_LARGE, 0xFFF000u);
+    snprintf(value, sizeof(value), "%3.1fmsec", std::round(total_time * 10) / 10);
+    img->write_string_rgb("Total AI Time : ", value, 2, TEXT_WIDTH_OFFSET,  LINE_HEIGHT_OFFSET + (LINE_HEIGHT * 1), CHAR_SCALE_LARGE, 0xFFF000u);
  
     /* Draw Inference Time on RGB image.*/
-    stream.str("");
-    stream << "  Inference   : " << std::setw(3) << std::fixed << std::setprecision(1) << std::round(ai_time * 10) / 10 << "msec";
-    str = stream.str();
-    img->write_string_rgb(str, 2, TEXT_WIDTH_OFFSET, LINE_HEIGHT_OFFSET + (LINE_HEIGHT * 2), CHAR_SCALE_LARGE, 0xFFF000u);
+    snprintf(value, sizeof(value), "%3.1fmsec", std::round(ai_time * 10) / 10);
+    img->write_string_rgb("  Inference   : ", value, 2, TEXT_WIDTH_OFFSET, LINE_HEIGHT_OFFSET + (LINE_HEIGHT * 2), CHAR_SCALE_LARGE, 0xFFF000u);
 
     /* Draw PreProcess Time on RGB image.*/
-    stream.str("");
-    stream << "  PreProcess  : " << std::setw(3) << std::fixed << std::setprecision(1) << std::round(pre_time * 10) / 10 << "msec";
-    str = stream.str();
-    img->write_string_rgb(str, 2, TEXT_WIDTH_OFFSET, LINE_HEIGHT_OFFSET + (LINE_HEIGHT * 3), CHAR_SCALE_LARGE, 0xFFF000u);
+    snprintf(value, sizeof(value), "%3.1fmsec", std::round(pre_time * 10) / 10);
+    img->write_string_rgb("  PreProcess  : ", value, 2, TEXT_WIDTH_OFFSET, LINE_HEIGHT_OFFSET + (LINE_HEIGHT * 3), CHAR_SCALE_LARGE, 0xFFF000u);
 
     /* Draw PostProcess Time on RGB image.*/
-    stream.str("");
-    stream << "  PostProcess : " << std::setw(3) << std::fixed << std::setprecision(1) << std::round(post_time * 10) / 10 << "msec";
-    str = stream.str();
-    img->write_string_rgb(str, 2, TEXT_WIDTH_OFFSET, LINE_HEIGHT_OFFSET + (LINE_HEIGHT * 4), CHAR_SCALE_LARGE, 0xFFF000u);
+    snprintf(value, sizeof(value), "%3.1fmsec", std::round(post_time * 10) / 10);
+    img->write_string_rgb("  PostProcess : ", value, 2, TEXT_WIDTH_OFFSET, LINE_HEIGHT_OFFSET + (LINE_HEIGHT * 4), CHAR_SCALE_LARGE, 0xFFF000u);
 
 #ifdef DISP_AI_FRAME_RATE
     /* Draw AI/Camera Frame Rate on RGB image.*/
-    stream.str("");
-    stream << "AI/Camera Frame Rate: " << std::setw(3) << (uint32_t)ai_fps << "/" << (uint32_t)cap_fps << "fps";
-    str = stream.str();
-    img->write_string_rgb(str, 2, TEXT_WIDTH_OFFSET, LINE_HEIGHT_OFFSET + (LINE_HEIGHT * 5), CHAR_SCALE_LARGE, 0xFFF000u);
+    snprintf(value, sizeof(value), "%3u/%ufps", (uint32_t)ai_fps, (uint32_t)cap_fps);
+    img->write_string_rgb("AI/Camera Frame Rate: ", value, 2, TEXT_WIDTH_OFFSET, LINE_HEIGHT_OFFSET + (LINE_HEIGHT * 5), CHAR_SCALE_LARGE, 0xFFF000u);
 #endif /* DISP_AI_FRAME_RATE */
 
 #ifdef DEBUG_TIME_FLG
@@ -427,15 +527,87 @@ int8_t print_result(Image* img)
     for (size_t i = 0, num=1; i < det_buff.size(); i++)
     {   
         uint32_t color = box_color[det_buff[i].c];
-        if (det_buff[i].prob != 0)
-        {
-            stream.str("");
-            stream << label_file_map[det_buff[i].c].c_str() << " " << std::setw(5) << std::fixed << std::setprecision(1) << round(det_buff[i].prob*100) << "%";
-            str = stream.str();
-            img->write_string_rgb(str, 1, TEXT_WIDTH_OFFSET*5, LINE_HEIGHT_OFFSET + (LINE_HEIGHT * num), CHAR_SCALE_SMALL, color);
-            num++;
-        }
+        snprintf(value, sizeof(value), " %5.1f%%", round(det_buff[i].prob*100));
+        img->write_string_rgb(label_file_map[det_buff[i].c].c_str(), value, 1, TEXT_WIDTH_OFFSET*5, LINE_HEIGHT_OFFSET + (LINE_HEIGHT * num), CHAR_SCALE_SMALL, color);
+        num++;
+    }
+#endif
+    return 0;
+}
+
+/*****************************************
+* Function Name : R_Post_Stage
+* Description   : CPU post-processing of the DRP-AI outputs in the output queue slot.
+* Arguments     : slot = slot of the output queue
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t R_Post_Stage(output_slot_t* slot)
+{
+    int8_t ret = 0;
+    struct timespec post_start_time;
+    struct timespec post_end_time;
+#if (1) == TENSOR_RECORD_MODE
+    tensor_record_frame record_info;
+    memset(&record_info, 0, sizeof(record_info));
+#endif
+
+    /*Gets Post-process starting time*/
+    ret = timespec_get(&post_start_time, TIME_UTC);
+    if (0 == ret)
+    {
+        fprintf(stderr, "[ERROR] Failed to get Post-process Start Time\n");
+        return -1;
+    }
+
+    /*Bind the copied DRP-AI outputs to the tensor views.*/
+    uint64_t fp16_start = LatencyHist::now();
+    ret = post_proc.set_outputs(slot->outputs.data(), slot->outputs.size());
+    if (0 != ret)
+    {
+        fprintf(stderr, "[ERROR] Failed to get result from memory.\n");
+        return ret;
+    }
+    latency_hist[LATENCY_FP16].record(LatencyHist::now() - fp16_start);
+
+    /*Preparation for Post-Processing*/
+    /*CPU Post-Processing For YOLOv6*/
+    R_Post_Proc(slot);
+
+    /* R_Post_Proc time end*/
+    ret = timespec_get(&post_end_time, TIME_UTC);
+    if (0 == ret)
+    {
+        fprintf(stderr, "[ERROR] Failed to Get R_Post_Proc End Time\n");
+        return -1;
     }
+    post_time = (timedifference_msec(post_start_time, post_end_time)*TIME_COEF);
+
+#if (1) == TENSOR_RECORD_MODE
+    /* Copy the DRP-AI outputs to the ring of the tensor recorder. The file is written by the writer thread. */
+    record_info.frame_no = slot->frame_no;
+    record_info.capture_time = (int64_t)slot->capture_time.tv_sec * 1000000000 + slot->capture_time.tv_nsec;
+    record_info.pre_time = slot->pre_time;
+    record_info.inf_time = slot->ai_time;
+    record_info.post_time = post_time;
+    tensor_recorder.push(record_info, slot->outputs.data());
+#endif
+
+    /*Display Processing Time On Log File*/
+#if (1) == DET_LOG_MODE
+    det_logger.push_frame(slot->frame_id, slot->frame_no,
+        (int64_t)slot->capture_time.tv_sec * 1000000000 + slot->capture_time.tv_nsec,
+        slot->pre_time, slot->ai_time, post_time, num_detection.load(std::memory_order_relaxed));
+#else
+    double total_time = slot->ai_time + slot->pre_time + post_time;
+    spdlog::info("Total AI Time  : {} [ms]", std::round(total_time * 10) / 10);
+    spdlog::info("PreProcess     : {} [ms]", std::round(slot->pre_time * 10) / 10);
+    spdlog::info("Inference      : {} [ms]", std::round(slot->ai_time * 10) / 10);
+    spdlog::info("PostProcess: {} [ms]", std::round(post_time * 10) / 10);
+#endif
+
+#if (1) == DISP_OVERLAY_MODE
+    result_cnt++;
 #endif
     return 0;
 }
@@ -466,18 +638,25 @@ void *R_Inf_Thread(void *threadid)
     static struct timespec inf_end_time;
     static struct timespec pre_start_time;
     static struct timespec pre_end_time;
-    static struct timespec post_start_time;
-    static struct timespec post_end_time;
     static struct timespec drp_prev_time = { .tv_sec = 0, .tv_nsec = 0, };
+    /*Slot of the output queue for the DRP-AI outputs*/
+    output_slot_t* slot = NULL;
+    /*Capture frame ID and capture time of the input image*/
+    uint64_t frame_id = 0;
+    struct timespec capture_time;
+    uint64_t stage_start = 0;
 
     printf("Inference Thread Starting\n");
+    frame_trace.register_thread("AI Inference Thread");
     printf("Inference Loop Starting\n");
     /*Inference Loop Start*/
     while(1)
     {
         inf_cnt++;
+#if (1) != DET_LOG_MODE
         spdlog::info("[START] Start DRP-AI Inference...");
         spdlog::info("Inference ----------- No. {}", (inf_cnt + 1));
+#endif
 #ifndef INPUT_IMAGE
         while(1)
         {
@@ -500,11 +679,18 @@ void *R_Inf_Thread(void *threadid)
             {
                 break;
             }
-            usleep(WAIT_TIME);
+            /*Sleeps until Capture Thread stores the image or termination is requested.*/
+            ret = inference_event.wait(terminate_event, -1);
+            if (EVENT_ERROR == ret)
+            {
+                goto err;
+            }
         }
 #endif
         in_param.pre_in_addr    = capture_address;
         in_param.input_copy_enabled = false;
+        frame_id = inference_frame_id;
+        capture_time = inference_capture_time;
         
         /*Gets Pre-process starting time*/
         ret = timespec_get(&pre_start_time, TIME_UTC);
@@ -513,7 +699,16 @@ void *R_Inf_Thread(void *threadid)
             fprintf(stderr, "[ERROR] Failed to get Pre-process Start Time\n");
             goto err;
         }
+        stage_start = LatencyHist::now();
         ret = preruntime.Pre(&in_param, &output_ptr, &out_size);
+        record_stage(LATENCY_PRE, TRACE_PRE, frame_id, stage_start);
+#if (1) == CAPTURE_ZERO_COPY_MODE
+        /* Pre() has read the capture buffer. */
+        capture_share.release(CAPTURE_USER_INFERENCE);
+#endif
+        /* Pre() has read the DRP-AI input buffer, so the Capture Thread can store the next frame
+           while DRP-AI runs the inference of this frame. */
+        inference_start.store(0);
         if (0 < ret)
         {
             fprintf(stderr, "[ERROR] Failed to run Pre-processing Runtime Pre()\n");
@@ -540,7 +735,9 @@ void *R_Inf_Thread(void *threadid)
             goto err;
         }
 
+        stage_start = LatencyHist::now();
         runtime.Run(drpai_freq);
+        record_stage(LATENCY_RUN, TRACE_RUN, frame_id, stage_start);
 
         /*Gets AI Inference End Time*/
         ret = timespec_get(&inf_end_time, TIME_UTC);
@@ -552,53 +749,41 @@ void *R_Inf_Thread(void *threadid)
         /*Inference Time Result*/
         ai_time = (timedifference_msec(inf_start_time, inf_end_time) * TIME_COEF);
 
-        /*Gets Post-process starting time*/
-        ret = timespec_get(&post_start_time, TIME_UTC);
-        if (0 == ret)
+        /*Copy the DRP-AI outputs to the output queue, so that the next frame can run on DRP-AI
+          while Post-processing Thread processes this frame.*/
+        slot = output_queue.acquire(terminate_event);
+        if (NULL == slot)
         {
-            fprintf(stderr, "[ERROR] Failed to get Post-process Start Time\n");
-            goto err;
+            goto ai_inf_end;
         }
-
-        inference_start.store(0);
-
-        /*Process to read the DRPAI output data.*/
         ret = get_result();
-        if (0 != ret)
+        if (0 == ret)
         {
-            fprintf(stderr, "[ERROR] Failed to get result from memory.\n");
-            goto err;
+            ret = output_queue.copy_outputs(slot, drpai_outputs.data(), drpai_outputs.size());
         }
-
-        /*Preparation for Post-Processing*/
-        /*CPU Post-Processing For YOLOv6*/
-        dfl.DFL_Proc(output_dfl80, output_dfl40, output_dfl20, output_class80, output_class40, output_class20, drpai_output_buf);
-
-        R_Post_Proc(drpai_output_buf);
-
-        /* R_Post_Proc time end*/
-        ret = timespec_get(&post_end_time, TIME_UTC);
-        if (0 == ret)
+        if (0 != ret)
         {
-            fprintf(stderr, "[ERROR] Failed to Get R_Post_Proc End Time\n");
+            fprintf(stderr, "[ERROR] Failed to get result from memory.\n");
             goto err;
         }
-        post_time = (timedifference_msec(post_start_time, post_end_time)*TIME_COEF);
+        slot->frame_no = inf_cnt;
+        slot->frame_id = frame_id;
+        slot->capture_time = capture_time;
+        slot->pre_time = pre_time;
+        slot->ai_time = ai_time;
 
         /*Display Processing Time On Log File*/
         drpai_time = timedifference_msec(inf_start_time, inf_end_time) * TIME_COEF;
         int idx = inf_cnt % SIZE_OF_ARRAY(array_drp_time);
         array_drp_time[idx] = ai_time;
         drp_prev_time = inf_end_time;
-        double total_time = ai_time + pre_time + post_time;
-        spdlog::info("Total AI Time  : {} [ms]", std::round(total_time * 10) / 10);
-        spdlog::info("PreProcess     : {} [ms]", std::round(pre_time   * 10) / 10);
-        spdlog::info("Inference      : {} [ms]", std::round(ai_time    * 10) / 10);
-        spdlog::info("PostProcess: {} [ms]", std::round(post_time * 10) / 10);
 
 #ifdef INPUT_IMAGE
+        /*Post-processing in this thread for the single image.*/
+        R_Post_Stage(slot);
         return 0;
 #endif
+        output_queue.push();
 
 #ifdef DISP_AI_FRAME_RATE
         int arraySum = std::accumulate(array_drp_time, array_drp_time + SIZE_OF_ARRAY(array_drp_time), 0);
@@ -612,7 +797,7 @@ void *R_Inf_Thread(void *threadid)
 /*Error Processing*/
 err:
     /*Set Termination Request Semaphore to 0*/
-    sem_trywait(&terminate_req_sem);
+    request_terminate();
     goto ai_inf_end;
 /*AI Thread Termination*/
 ai_inf_end:
@@ -621,6 +806,65 @@ ai_inf_end:
     pthread_exit(NULL);
 }
 
+/*****************************************
+* Function Name : R_Post_Thread
+* Description   : Executes the CPU post-processing of the frames in the output queue
+*                 in parallel with the DRP-AI inference of the next frame.
+* Arguments     : threadid = thread identification
+* Return value  : -
+******************************************/
+void *R_Post_Thread(void *threadid)
+{
+    /*Semaphore Variable*/
+    int32_t post_sem_check = 0;
+    /*Variable for checking return value*/
+    int8_t ret = 0;
+    output_slot_t* slot = NULL;
+
+    printf("Post-processing Thread Starting\n");
+    frame_trace.register_thread("Post-processing Thread");
+    while(1)
+    {
+        /*Gets the Termination request semaphore value. If different then 1 Termination was requested*/
+        /*Checks if sem_getvalue is executed wihtout issue*/
+        errno = 0;
+        ret = sem_getvalue(&terminate_req_sem, &post_sem_check);
+        if (0 != ret)
+        {
+            fprintf(stderr, "[ERROR] Failed to get Semaphore Value: errno=%d\n", errno);
+            goto err;
+        }
+        /*Checks the semaphore value*/
+        if (1 != post_sem_check)
+        {
+            goto post_end;
+        }
+
+        /*Sleeps until AI Inference Thread pushes a frame or termination is requested.*/
+        slot = output_queue.front(terminate_event);
+        if (NULL == slot)
+        {
+            goto post_end;
+        }
+        ret = R_Post_Stage(slot);
+        output_queue.pop();
+        if (0 != ret)
+        {
+            goto err;
+        }
+    }
+
+/*Error Processing*/
+err:
+    /*Set Termination Request Semaphore to 0*/
+    request_terminate();
+    goto post_end;
+
+post_end:
+    printf("Post-processing Thread Terminated\n");
+    pthread_exit(NULL);
+}
+
 /*****************************************
 * Function Name : R_Capture_Thread
 * Description   : Executes the V4L2 capture with Capture thread.
@@ -637,8 +881,15 @@ void *R_Capture_Thread(void *threadid)
     int8_t ret = 0;
     uint8_t * img_buffer;
     uint8_t * img_buffer0;
+    int32_t slot = -1;
 
     uint8_t capture_stabe_cnt = 8;  // Counter to wait for the camera to stabilize
+    /*Capture frame ID (1, 2, ...) and capture time of the frame*/
+    uint64_t frame_id = 0;
+    uint64_t capture_ts = 0;
+    uint64_t capture_prev_ts = 0;
+    uint64_t stage_start = 0;
+    struct timespec image_capture_time;
 #ifdef DISP_AI_FRAME_RATE
     int32_t cap_cnt = -1;
     static struct timespec capture_time;
@@ -646,6 +897,7 @@ void *R_Capture_Thread(void *threadid)
 #endif /* DISP_AI_FRAME_RATE */
 
     printf("Capture Thread Starting\n");
+    frame_trace.register_thread("Capture Thread");
 
     img_buffer0 = (uint8_t *)capture->drpai_buf->mem;
 
@@ -681,8 +933,17 @@ void *R_Capture_Thread(void *threadid)
             goto capture_end;
         }
 
-        /* Capture USB camera image and stop updating the capture buffer */
-        capture_addr = (uint32_t)capture->capture_image();
+        /* Capture USB camera image and stop updating the capture buffer.
+           The physical address of the dequeued capture buffer is returned. */
+        capture_addr = capture->capture_image();
+        /* Capture time of the frame trace. The V4L2 buffer timestamp is not available from Camera. */
+        capture_ts = LatencyHist::now();
+        if (0 != capture_prev_ts)
+        {
+            latency_hist[LATENCY_CAPTURE].record(capture_ts - capture_prev_ts);
+        }
+        capture_prev_ts = capture_ts;
+        timespec_get(&image_capture_time, TIME_UTC);
 
 #ifdef DISP_AI_FRAME_RATE
         cap_cnt++;
@@ -712,9 +973,18 @@ void *R_Capture_Thread(void *threadid)
             else
             {
                 img_buffer = capture->get_img();
+                frame_id++;
+                num_captured_frame.store(frame_id, std::memory_order_relaxed);
                 if (!inference_start.load())
                 {
+#if ((1) == CAPTURE_ZERO_COPY_MODE) && ((0) == DRPAI_INPUT_PADDING)
+                    /* Give the capture buffer itself to the pre-processing. It is requeued after Pre().
+                       No cache flush is needed, since the CPU does not write the capture buffer. */
+                    capture_address = capture_addr;
+                    capture_share.take(CAPTURE_USER_INFERENCE);
+#else
                     /* Copy captured image to Image object. This will be used in Display Thread. */
+                    stage_start = LatencyHist::now();
                     memcpy(img_buffer0, img_buffer, capture->get_size());
                     /* Flush capture image area cache */
                     ret = capture->video_buffer_flush_dmabuf(capture->drpai_buf->idx, capture->drpai_buf->size);
@@ -722,22 +992,48 @@ void *R_Capture_Thread(void *threadid)
                     {
                         goto err;
                     }
+                    capture_address = capture->drpai_buf->phy_addr;
+                    record_stage(LATENCY_COPY, TRACE_DRP_COPY, frame_id, stage_start);
+#endif
+                    inference_capture_time = image_capture_time;
+                    inference_frame_id = frame_id;
                     inference_start.store(1); /* Flag for AI Inference Thread. */
+                    inference_event.signal();
                 }
 
-                if (!img_obj_ready.load())
+                /* The frame is dropped (and counted) when all slots are in use. */
+                slot = headless ? -1 : frame_ring.acquire_capture();
+                if (0 <= slot)
                 {
-                    img.camera_to_image(img_buffer, capture->get_size());
+#if (1) == CAPTURE_ZERO_COPY_MODE
+                    /* Image Thread converts the capture buffer itself. It is requeued after the conversion. */
+                    capture_share.take(CAPTURE_USER_DISPLAY);
+                    img.set_camera_buffer(slot, img_buffer);
+#else
+                    img.camera_to_image(slot, img_buffer, capture->get_size());
                     ret = capture->video_buffer_flush_dmabuf(capture->wayland_buf->idx, capture->wayland_buf->size);
                     if (0 != ret)
                     {
                         goto err;
                     }
-                    img_obj_ready.store(1); /* Flag for Display Thread. */
+#endif
+                    display_frame_id[slot] = frame_id;
+                    display_capture_time[slot] = capture_ts;
+                    frame_ring.publish_capture(slot); /* Hand over to Image Thread. */
+                    capture_event.signal();
                 }
+                frame_trace.record(TRACE_CAPTURE, frame_id, capture_ts);
             }
         }
 
+#if (1) == CAPTURE_ZERO_COPY_MODE
+        /* Keep the capture buffer dequeued until AI Inference Thread and Image Thread finish reading it. */
+        ret = capture_share.wait_released(terminate_event);
+        if (EVENT_ERROR == ret)
+        {
+            goto err;
+        }
+#endif
         /* IMPORTANT: Place back the image buffer to the capture queue */
         ret = capture->capture_qbuf();
         if (0 != ret)
@@ -749,12 +1045,13 @@ void *R_Capture_Thread(void *threadid)
 
 /*Error Processing*/
 err:
-    sem_trywait(&terminate_req_sem);
+    request_terminate();
     goto capture_end;
 
 capture_end:
     /*To terminate the loop in AI Inference Thread.*/
     inference_start.store(1);
+    inference_event.signal();
 
     printf("Capture Thread Terminated\n");
     pthread_exit(NULL);
@@ -772,14 +1069,16 @@ void *R_Img_Thread(void *threadid)
     int32_t hdmi_sem_check = 0;
     /*Variable for checking return value*/
     int8_t ret = 0;
-    bool padding = false;
-#ifdef CAM_INPUT_VGA
-    padding = true;
-#endif // CAM_INPUT_VGA
     timespec start_time;
     timespec end_time;
+    int32_t slot = -1;
+    uint64_t stage_start = 0;
+#if (1) == DISP_OVERLAY_MODE
+    uint32_t overlay_cnt = 0;
+#endif
 
     printf("Image Thread Starting\n");
+    frame_trace.register_thread("Image Thread");
     while(1)
     {
         /*Gets The Termination Request Semaphore Value, If Different Then 1 Termination Is Requested*/
@@ -796,8 +1095,9 @@ void *R_Img_Thread(void *threadid)
         {
             goto hdmi_end;
         }
-        /* Check img_obj_ready flag which is set in Capture Thread. */
-        if (img_obj_ready.load())
+        /* Take the newest frame stored by Capture Thread. */
+        slot = frame_ring.acquire_convert();
+        if (0 <= slot)
         {
             ret = timespec_get(&start_time, TIME_UTC);
             if (0 == ret)
@@ -805,26 +1105,68 @@ void *R_Img_Thread(void *threadid)
                 fprintf(stderr, "[ERROR] Failed to get Display Start Time\n");
                 goto err;
             }
+            img.set_buf_id(slot);
+            stage_start = LatencyHist::now();
                         
+#ifdef CAM_INPUT_VGA
+            /* Convert YUYV image to BGRA format with 2x upscale and letterbox in one pass. */
+            img.convert_format_upscale();
+#if (1) == CAPTURE_ZERO_COPY_MODE
+            capture_share.release(CAPTURE_USER_DISPLAY);
+#endif
+            stage_start = record_stage(LATENCY_CONVERT, TRACE_CONVERT, display_frame_id[slot], stage_start);
+
+#if (1) != DISP_OVERLAY_MODE
+            /* Draw bounding box on image. */
+            draw_bounding_box();
+#endif
+#else
             /* Convert YUYV image to BGRA format. */
             img.convert_format();
+#if (1) == CAPTURE_ZERO_COPY_MODE
+            capture_share.release(CAPTURE_USER_DISPLAY);
+#endif
+            stage_start = record_stage(LATENCY_CONVERT, TRACE_CONVERT, display_frame_id[slot], stage_start);
 
+#if (1) != DISP_OVERLAY_MODE
             /* Draw bounding box on image. */
             draw_bounding_box();
+#endif
 
             /* Convert output image size. */
-            img.convert_size(CAM_IMAGE_WIDTH, CAM_RESIZED_WIDTH, CAM_IMAGE_HEIGHT, CAM_RESIZED_HEIGHT, padding);
+            img.convert_size(CAM_IMAGE_WIDTH, CAM_RESIZED_WIDTH, CAM_IMAGE_HEIGHT, CAM_RESIZED_HEIGHT, false);
+#endif // CAM_INPUT_VGA
 
+#if (1) == DISP_OVERLAY_MODE
+            /* Redraw the overlay only when the AI result is updated
+             * and the previous overlay has been committed. */
+            if ((overlay_cnt != result_cnt.load()) && !overlay_ready.load())
+            {
+                overlay_cnt = result_cnt.load();
+                img.reset_overlay_img();
+                draw_bounding_box();
+                print_result(&img);
+                overlay_id = img.get_overlay_id();
+                overlay_ready.store(1);
+            }
+#else
         	/*displays AI Inference Results on display.*/
             print_result(&img);
+#endif
 
-            buf_id = img.get_buf_id();
-            img_obj_ready.store(0);
-
-            if (!hdmi_obj_ready.load())
+#if (1) == CAPTURE_ZERO_COPY_MODE
+            /* Flush the converted image area cache. (Capture Thread does not copy to the display buffer.) */
+            ret = capture->video_buffer_flush_dmabuf(capture->wayland_buf->idx, capture->wayland_buf->size);
+            if (0 != ret)
             {
-                hdmi_obj_ready.store(1); /* Flag for AI Inference Thread. */
+                goto err;
             }
+#endif
+            latency_hist[LATENCY_DRAW].record(LatencyHist::now() - stage_start);
+            /* ref is the capture frame ID of the AI result drawn on this frame. */
+            frame_trace.record(TRACE_DRAW, display_frame_id[slot], stage_start, drawn_frame_id);
+            frame_ring.publish_convert(slot); /* Hand over to Display Thread. */
+            convert_event.signal();
             
             ret = timespec_get(&end_time, TIME_UTC);
             if (0 == ret)
@@ -838,18 +1180,24 @@ void *R_Img_Thread(void *threadid)
             printf("Img Proc Time             : %lf[ms]\n", img_proc_time);
 #endif
         }
-        usleep(WAIT_TIME); //wait 1 tick time
+        else
+        {
+            /*Sleeps until Capture Thread stores a frame or termination is requested.*/
+            ret = capture_event.wait(terminate_event, -1);
+            if (EVENT_ERROR == ret)
+            {
+                goto err;
+            }
+        }
     } /*End Of Loop*/
 
 /*Error Processing*/
 err:
     /*Set Termination Request Semaphore To 0*/
-    sem_trywait(&terminate_req_sem);
+    request_terminate();
     goto hdmi_end;
 
 hdmi_end:
-    /*To terminate the loop in Capture Thread.*/
-    img_obj_ready.store(0);
     printf("Img Thread Terminated\n");
     pthread_exit(NULL);
 }
@@ -867,13 +1215,19 @@ void *R_Display_Thread(void *threadid)
     /*Variable for checking return value*/
     int8_t ret = 0;
     int32_t disp_cnt = 0;
+    int32_t slot = -1;
+    uint64_t stage_start = 0;
 
     timespec start_time;
     timespec end_time;
     static struct timespec disp_prev_time = { .tv_sec = 0, .tv_nsec = 0, };
 
     /* Initialize waylad */
+#if (1) == DISP_OVERLAY_MODE
+    ret = wayland.init(capture->wayland_buf->idx, IMAGE_OUTPUT_WIDTH, IMAGE_OUTPUT_HEIGHT, IMAGE_CHANNEL_BGRA, true);
+#else
     ret = wayland.init(capture->wayland_buf->idx, IMAGE_OUTPUT_WIDTH, IMAGE_OUTPUT_HEIGHT, IMAGE_CHANNEL_BGRA);
+#endif
 
     if(0 != ret)
     {
@@ -882,6 +1236,7 @@ void *R_Display_Thread(void *threadid)
     }
 
     printf("Display Thread Starting\n");
+    frame_trace.register_thread("Display Thread");
     while(1)
     {
         /*Gets The Termination Request Semaphore Value, If Different Then 1 Termination Is Requested*/
@@ -898,8 +1253,9 @@ void *R_Display_Thread(void *threadid)
         {
             goto hdmi_end;
         }
-        /* Check hdmi_obj_ready flag which is set in Capture Thread. */
-        if (hdmi_obj_ready.load())
+        /* Take the newest frame converted by Image Thread. */
+        slot = frame_ring.acquire_display();
+        if (0 <= slot)
         {
             ret = timespec_get(&start_time, TIME_UTC);
             if (0 == ret)
@@ -907,8 +1263,28 @@ void *R_Display_Thread(void *threadid)
                 fprintf(stderr, "[ERROR] Failed to get Display Start Time\n");
                 goto err;
             }
+            stage_start = LatencyHist::now();
             /*Update Wayland*/
-            wayland.commit(img.get_img(buf_id), NULL);
+#if (1) == DISP_OVERLAY_MODE
+            /* The overlay surface keeps the last committed overlay until a new one is drawn. */
+            if (overlay_ready.load())
+            {
+                wayland.commit(img.get_img(slot), img.get_overlay_img(overlay_id));
+                overlay_ready.store(0);
+            }
+            else
+            {
+                wayland.commit(img.get_img(slot), NULL);
+            }
+#else
+            wayland.commit(img.get_img(slot), NULL);
+#endif
+            stage_start = record_stage(LATENCY_COMMIT, TRACE_COMMIT, display_frame_id[slot], stage_start);
+            /* Capture to display latency of the frame */
+            latency_hist[LATENCY_FRAME].record(stage_start - display_capture_time[slot]);
+            frame_trace.record_span(TRACE_FRAME, display_frame_id[slot], display_capture_time[slot], stage_start);
+            /* The slot stays on the display until the next commit. */
+            frame_ring.release_display(slot);
 
 #if END_DET_TYPE // To display the app_pointer_det in front of this application.
             if (display_state == 0) 
@@ -917,7 +1293,6 @@ void *R_Display_Thread(void *threadid)
             }
 #endif
 
-            hdmi_obj_ready.store(0);
             ret = timespec_get(&end_time, TIME_UTC);
             if (0 == ret)
             {
@@ -940,22 +1315,171 @@ void *R_Display_Thread(void *threadid)
             printf("Dipslay ------------------------------ No. %d\n", disp_cnt);
 #endif
         }
-        usleep(WAIT_TIME); //wait 1 tick time
+        else
+        {
+            /*Sleeps until Image Thread converts a frame or termination is requested.*/
+            ret = convert_event.wait(terminate_event, -1);
+            if (EVENT_ERROR == ret)
+            {
+                goto err;
+            }
+        }
     } /*End Of Loop*/
 
 /*Error Processing*/
 err:
     /*Set Termination Request Semaphore To 0*/
-    sem_trywait(&terminate_req_sem);
+    request_terminate();
     goto hdmi_end;
 
 hdmi_end:
-    /*To terminate the loop in Capture Thread.*/
-    hdmi_obj_ready.store(0);
     printf("Display Thread Terminated\n");
     pthread_exit(NULL);
 }
 
+/*****************************************
+* Function Name : build_metrics
+* Description   : Make the metrics snapshot in the Prometheus text format.
+*                 Only reads the counters and the latency histograms updated by the other threads.
+* Arguments     : out = metrics text
+* Return value  : -
+******************************************/
+static void build_metrics(std::string& out)
+{
+    frame_ring_stats_t ring = frame_ring.get_stats();
+    output_queue_stats_t queue = output_queue.get_stats();
+    latency_snapshot_t snap;
+    char labels[64];
+    uint32_t stage;
+
+    out.clear();
+    MetricsServer::add_header(out, "yolo_frames_captured_total", "counter", "Camera frames captured after the camera is stabilized.");
+    MetricsServer::add_value(out, "yolo_frames_captured_total", NULL, num_captured_frame.load());
+    MetricsServer::add_header(out, "yolo_frames_inferred_total", "counter", "Frames inferred by DRP-AI.");
+    MetricsServer::add_value(out, "yolo_frames_inferred_total", NULL, queue.num_pushed);
+    MetricsServer::add_header(out, "yolo_frames_post_processed_total", "counter", "Frames post-processed by CPU.");
+    MetricsServer::add_value(out, "yolo_frames_post_processed_total", NULL, queue.num_pushed - queue.depth);
+    MetricsServer::add_header(out, "yolo_frames_displayed_total", "counter", "Frames committed to Wayland.");
+    MetricsServer::add_value(out, "yolo_frames_displayed_total", NULL, ring.displayed);
+    MetricsServer::add_header(out, "yolo_frames_dropped_total", "counter", "Captured frames not displayed.");
+    MetricsServer::add_value(out, "yolo_frames_dropped_total", "reason=\"no_slot\"", ring.drop_no_slot);
+    MetricsServer::add_value(out, "yolo_frames_dropped_total", "reason=\"before_conversion\"", ring.drop_captured);
+    MetricsServer::add_value(out, "yolo_frames_dropped_total", "reason=\"before_display\"", ring.drop_converted);
+    MetricsServer::add_header(out, "yolo_output_queue_waits_total", "counter", "Times a stage waited on the output queue.");
+    MetricsServer::add_value(out, "yolo_output_queue_waits_total", "stage=\"inference\"", queue.stall_push);
+    MetricsServer::add_value(out, "yolo_output_queue_waits_total", "stage=\"post_processing\"", queue.stall_pop);
+
+    MetricsServer::add_header(out, "yolo_stage_latency_seconds", "summary", "Latency of each pipeline stage since the start.");
+    for (stage = 0; stage < LATENCY_STAGE_NUM; stage++)
+    {
+        latency_hist[stage].snapshot(&snap, false);
+        if (0 == snap.count)
+        {
+            continue;
+        }
+        snprintf(labels, sizeof(labels), "stage=\"%s\",quantile=\"0.5\"", LatencyHist::get_stage_name(stage));
+        MetricsServer::add_value(out, "yolo_stage_latency_seconds", labels, LatencyHist::percentile(&snap, 50) / 1e9);
+        snprintf(labels, sizeof(labels), "stage=\"%s\",quantile=\"0.99\"", LatencyHist::get_stage_name(stage));
+        MetricsServer::add_value(out, "yolo_stage_latency_seconds", labels, LatencyHist::percentile(&snap, 99) / 1e9);
+        snprintf(labels, sizeof(labels), "stage=\"%s\"", LatencyHist::get_stage_name(stage));
+        MetricsServer::add_value(out, "yolo_stage_latency_seconds_sum", labels, snap.sum / 1e9);
+        MetricsServer::add_value(out, "yolo_stage_latency_seconds_count", labels, snap.count);
+    }
+    MetricsServer::add_header(out, "yolo_stage_latency_max_seconds", "gauge", "Max latency of each pipeline stage since the start.");
+    for (stage = 0; stage < LATENCY_STAGE_NUM; stage++)
+    {
+        latency_hist[stage].snapshot(&snap, false);
+        if (0 == snap.count)
+        {
+            continue;
+        }
+        snprintf(labels, sizeof(labels), "stage=\"%s\"", LatencyHist::get_stage_name(stage));
+        MetricsServer::add_value(out, "yolo_stage_latency_max_seconds", labels, snap.max / 1e9);
+    }
+
+    MetricsServer::add_header(out, "yolo_candidate_boxes", "gauge", "Boxes over the threshold before NMS in the last frame.");
+    MetricsServer::add_value(out, "yolo_candidate_boxes", NULL, num_candidate.load());
+    MetricsServer::add_header(out, "yolo_candidate_boxes_total", "counter", "Boxes over the threshold before NMS.");
+    MetricsServer::add_value(out, "yolo_candidate_boxes_total", NULL, num_candidate_total.load());
+    MetricsServer::add_header(out, "yolo_detected_boxes", "gauge", "Boxes after NMS in the last frame.");
+    MetricsServer::add_value(out, "yolo_detected_boxes", NULL, num_detection.load());
+    MetricsServer::add_header(out, "yolo_detected_boxes_total", "counter", "Boxes after NMS.");
+    MetricsServer::add_value(out, "yolo_detected_boxes_total", NULL, num_detection_total.load());
+
+    MetricsServer::add_header(out, "yolo_drp_max_freq_factor", "gauge", "DRP0 max frequency factor (argument 1).");
+    MetricsServer::add_value(out, "yolo_drp_max_freq_factor", NULL, drp_max_freq);
+    MetricsServer::add_header(out, "yolo_drpai_freq_factor", "gauge", "AI-MAC frequency factor (argument 2).");
+    MetricsServer::add_value(out, "yolo_drpai_freq_factor", NULL, drpai_freq);
+}
+
+/*****************************************
+* Function Name : R_Metrics_Thread
+* Description   : Executes the thread that writes the metrics snapshot to the clients of the metrics socket.
+* Arguments     : threadid = thread identification
+* Return value  : -
+******************************************/
+void *R_Metrics_Thread(void *threadid)
+{
+    /*Semaphore Variable*/
+    int32_t metrics_sem_check = 0;
+    /*Variable for checking return value*/
+    int8_t ret = 0;
+    std::string text;
+
+    printf("Metrics Thread Starting\n");
+    while(1)
+    {
+        /*Gets the Termination request semaphore value. If different then 1 Termination was requested*/
+        errno = 0;
+        ret = sem_getvalue(&terminate_req_sem, &metrics_sem_check);
+        if (0 != ret)
+        {
+            fprintf(stderr, "[ERROR] Failed to get Semaphore Value: errno=%d\n", errno);
+            goto err;
+        }
+        /*Checks the semaphore value*/
+        if (1 != metrics_sem_check)
+        {
+            goto metrics_end;
+        }
+
+        /*Sleeps until a client connects or termination is requested.*/
+        ret = Event::wait_fd(metrics_server.get_fd(), terminate_event, -1);
+        if (EVENT_ERROR == ret)
+        {
+            goto err;
+        }
+        if (EVENT_SIGNALED == ret)
+        {
+            build_metrics(text);
+            ret = metrics_server.serve(text);
+            if (METRICS_SERVE_ERROR == ret)
+            {
+                goto err;
+            }
+            if (METRICS_SERVE_RETRY == ret)
+            {
+                /*The client is still waiting. Sleeps so as not to retry at once (e.g. out of file descriptors).*/
+                ret = Event::wait_fd(-1, terminate_event, METRICS_RETRY_INTERVAL);
+                if (EVENT_ERROR == ret)
+                {
+                    goto err;
+                }
+            }
+        }
+    }
+
+/*Error Processing*/
+err:
+    /*The application keeps running without the metrics.*/
+    fprintf(stderr, "[WARNING] Metrics Thread stopped.\n");
+    goto metrics_end;
+
+metrics_end:
+    printf("Metrics Thread Terminated\n");
+    pthread_exit(NULL);
+}
+
 /*****************************************
 * Function Name : R_Kbhit_Thread
 * Description   : Executes the Keyboard hit thread (checks if enter key is hit)
@@ -1029,6 +1553,9 @@ void *R_Kbhit_Thread(void *threadid)
             }
         }
         close(fd);
+
+        /* When nothing is detected. */
+        usleep(WAIT_TIME);
 #else
         c = getchar();
         if (EOF != c)
@@ -1037,16 +1564,21 @@ void *R_Kbhit_Thread(void *threadid)
             printf("key Detected.\n");
             goto err;
         }
-#endif // END_DET_TYPE
 
-        /* When nothing is detected. */
-        usleep(WAIT_TIME);
+        /* When nothing is detected, sleeps until a key is pressed or termination is requested.
+         * Once stdin reaches its end, waits only for the termination. */
+        ret = Event::wait_fd(feof(stdin) ? -1 : STDIN_FILENO, terminate_event, -1);
+        if (EVENT_ERROR == ret)
+        {
+            goto err;
+        }
+#endif // END_DET_TYPE
     }
 
 /*Error Processing*/
 err:
     /*Set Termination Request Semaphore to 0*/
-    sem_trywait(&terminate_req_sem);
+    request_terminate();
     goto key_hit_end;
 
 key_hit_end:
@@ -1100,6 +1632,8 @@ int8_t R_Main_Process()
     int32_t sem_check = 0;
     /*Variable for checking return value*/
     int8_t ret = 0;
+    /*Wait time of the main loop [ms]*/
+    int32_t timeout = -1;
 
 #ifdef INPUT_IMAGE
     /* image read */
@@ -1114,35 +1648,48 @@ int8_t R_Main_Process()
 
     int32_t image_size = width*height*channels;
 
-    ret = img.init(CAM_IMAGE_WIDTH, CAM_IMAGE_HEIGHT, CAM_IMAGE_CHANNEL_YUY2, IMAGE_OUTPUT_WIDTH, IMAGE_OUTPUT_HEIGHT, IMAGE_CHANNEL_BGRA);
-    if (0 != ret)
+    if (!headless)
     {
-        fprintf(stderr, "[ERROR] Failed to initialize Image object.\n");
+        ret = img.init(CAM_IMAGE_WIDTH, CAM_IMAGE_HEIGHT, CAM_IMAGE_CHANNEL_YUY2, IMAGE_OUTPUT_WIDTH, IMAGE_OUTPUT_HEIGHT, IMAGE_CHANNEL_BGRA);
+        if (0 != ret)
+        {
+            fprintf(stderr, "[ERROR] Failed to initialize Image object.\n");
+        }
+        img.camera_to_image(img.get_buf_id(), yuyvBuffer.data(), image_size);
     }
-    img.camera_to_image(yuyvBuffer.data(), image_size);
 
     capture_address = (uint64_t) yuyvBuffer.data();
+    timespec_get(&inference_capture_time, TIME_UTC);
     R_Inf_Thread(NULL);
 
     // output
-    /* Convert YUYV image to BGRA format. */
-    img.convert_format();    
-    /* Draw bounding box on image. */
-    draw_bounding_box();
-    /* Convert output image size. */
-    bool padding = true;
-    img.convert_size(CAM_IMAGE_WIDTH, CAM_RESIZED_WIDTH, CAM_IMAGE_HEIGHT, CAM_RESIZED_HEIGHT, padding);
-
-    /* output image. */
-    buf_id = img.get_buf_id();
-    cv::Mat out_image(CAM_IMAGE_HEIGHT, CAM_IMAGE_WIDTH, CV_8UC4, img.get_img(buf_id));    
-    cv::imwrite("./output.png",out_image);
+    if (!headless)
+    {
+        /* Convert YUYV image to BGRA format. */
+        img.convert_format();    
+        /* Draw bounding box on image. */
+        draw_bounding_box();
+        /* Convert output image size. */
+        bool padding = true;
+        img.convert_size(CAM_IMAGE_WIDTH, CAM_RESIZED_WIDTH, CAM_IMAGE_HEIGHT, CAM_RESIZED_HEIGHT, padding);
+
+        /* output image. */
+        cv::Mat out_image(CAM_IMAGE_HEIGHT, CAM_IMAGE_WIDTH, CV_8UC4, img.get_img(img.get_buf_id()));    
+        cv::imwrite("./output.png",out_image);
+    }
 
     goto main_proc_end;
 
 #else
 
     printf("Main Loop Starts\n");
+#if (1) == FRAME_TRACE_MODE
+    /* SIGUSR1 is blocked in the other threads, so that it interrupts only the wait below. */
+    sigset_t trace_sigset;
+    sigemptyset(&trace_sigset);
+    sigaddset(&trace_sigset, SIGUSR1);
+    pthread_sigmask(SIG_UNBLOCK, &trace_sigset, NULL);
+#endif
     while(1)
     {
         /*Gets the Termination request semaphore value. If different then 1 Termination was requested*/
@@ -1170,14 +1717,33 @@ int8_t R_Main_Process()
             display_state = 2;
         }
 #endif
-        /*Wait for 1 TICK.*/
-        usleep(WAIT_TIME);
+#if END_DET_TYPE
+        /*Wait for 1 TICK to check display_state.*/
+        timeout = WAIT_TIME / 1000;
+#else
+        /*Sleeps until termination is requested.*/
+        timeout = -1;
+#endif
+#if (1) == FRAME_TRACE_MODE
+        /*Also wakes up on SIGUSR1 to export the frame trace.*/
+        ret = trace_request_event.wait(terminate_event, timeout);
+        if (EVENT_SIGNALED == ret)
+        {
+            frame_trace.export_json(FRAME_TRACE_FILE);
+        }
+#else
+        ret = Event::wait_fd(-1, terminate_event, timeout);
+#endif
+        if (EVENT_ERROR == ret)
+        {
+            goto err;
+        }
     }
 
 #endif
 /*Error Processing*/
 err:
-    sem_trywait(&terminate_req_sem);
+    request_terminate();
     main_ret = 1;
     goto main_proc_end;
 /*Main Processing Termination*/
@@ -1280,6 +1846,16 @@ uint32_t init_drpai(int drpai_fd)
 
 int32_t main(int32_t argc, char * argv[])
 {
+#if (1) == FRAME_TRACE_MODE
+    /* Block SIGUSR1 before any thread is created, so that every thread inherits the mask.
+     * Main Process unblocks it in R_Main_Process. */
+    {
+        sigset_t trace_sigset;
+        sigemptyset(&trace_sigset);
+        sigaddset(&trace_sigset, SIGUSR1);
+        pthread_sigmask(SIG_BLOCK, &trace_sigset, NULL);
+    }
+#endif
     /* Log File Setting */
     auto now = std::chrono::system_clock::now();
     auto tm_time = spdlog::details::os::localtime(std::chrono::system_clock::to_time_t(now));
@@ -1290,6 +1866,42 @@ int32_t main(int32_t argc, char * argv[])
     sprintf(time_buf,"logs/%s_app_yolov6_cam.log",date_buf);
     auto logger = spdlog::basic_logger_mt("logger", time_buf);
     spdlog::set_default_logger(logger);
+#if (1) == DET_LOG_MODE
+    /* The detections of each frame are written to the binary log by the writer thread. */
+    sprintf(time_buf,"logs/%s_app_yolov6_cam.det",date_buf);
+    if (0 != det_logger.open(time_buf, DET_LOG_RING_NUM, DET_LOG_FLUSH_INTERVAL))
+    {
+        fprintf(stderr, "[ERROR] Failed to open the detection log : %s\n", time_buf);
+        return -1;
+    }
+#endif
+#if (1) == DET_SHM_MODE
+    /* Opened before the threads are created, so that the first frames are published.
+       The application runs without publishing the detections if the shared memory is not available. */
+    if (0 == det_publisher.open(DET_SHM_NAME, DET_SHM_SLOT_NUM))
+    {
+        printf("Detection Shared Memory : %s\n", DET_SHM_NAME);
+    }
+    else
+    {
+        fprintf(stderr, "[WARNING] Failed to open the detection shared memory.\n");
+    }
+#endif
+
+    /* Headless mode: "--headless" may be given at any position and is removed from the arguments. */
+    for (int32_t i = 1; i < argc; i++)
+    {
+        if (0 == strcmp(argv[i], "--headless"))
+        {
+            headless = true;
+            for (int32_t j = i; j < argc - 1; j++)
+            {
+                argv[j] = argv[j + 1];
+            }
+            argc--;
+            i--;
+        }
+    }
 
     /* DRP-AI Frequency Setting */
     if (2 <= argc)
@@ -1314,10 +1926,12 @@ int32_t main(int32_t argc, char * argv[])
     int8_t ret_main = 0;
     /*Multithreading Variables*/
     int32_t create_thread_ai = -1;
+    int32_t create_thread_post = -1;
     int32_t create_thread_key = -1;
     int32_t create_thread_capture = -1;
     int32_t create_thread_img = -1;
     int32_t create_thread_hdmi = -1;
+    int32_t create_thread_metrics = -1;
     int32_t sem_create = -1;
 #if (1) // TVM
     InOutDataType input_data_type;
@@ -1334,6 +1948,10 @@ int32_t main(int32_t argc, char * argv[])
     spdlog::info("************************************************");
     printf("Argument : <DRP0_max_freq_factor> = %d\n", drp_max_freq);
     printf("Argument : <AI-MAC_freq_factor> = %d\n", drpai_freq);
+    if (headless)
+    {
+        printf("Argument : --headless (no display)\n");
+    }
 
 #if (1) // TVM
     uint64_t drpaimem_addr_start = 0;
@@ -1388,6 +2006,23 @@ int32_t main(int32_t argc, char * argv[])
     }
 #endif  // TVM
 
+    /*Initialize the output queue between AI Inference Thread and Post-processing Thread*/
+    ret = output_queue.init(AI_OUTPUT_BUF_NUM);
+    if (0 != ret)
+    {
+        fprintf(stderr, "[ERROR] Failed to initialize Output Queue.\n");
+        goto end_close_drpai;
+    }
+
+#if (1) == TENSOR_RECORD_MODE
+    ret = start_tensor_record();
+    if (0 != ret)
+    {
+        fprintf(stderr, "[ERROR] Failed to start the tensor record.\n");
+        goto end_close_drpai;
+    }
+#endif
+
 #ifndef INPUT_IMAGE
     /* Create Camera Instance */
     capture = new Camera();
@@ -1402,13 +2037,36 @@ int32_t main(int32_t argc, char * argv[])
         goto end_main;
     }
 
-    /*Initialize Image object.*/
-    ret = img.init(CAM_IMAGE_WIDTH, CAM_IMAGE_HEIGHT, CAM_IMAGE_CHANNEL_YUY2, IMAGE_OUTPUT_WIDTH, IMAGE_OUTPUT_HEIGHT, IMAGE_CHANNEL_BGRA, capture->wayland_buf->mem);
-    if (0 != ret)
+    /*Initialize Image object. (Not used in the headless mode)*/
+    if (!headless)
     {
-        fprintf(stderr, "[ERROR] Failed to initialize Image object.\n");
-        ret_main = ret;
-        goto end_close_camera;
+        ret = img.init(CAM_IMAGE_WIDTH, CAM_IMAGE_HEIGHT, CAM_IMAGE_CHANNEL_YUY2, IMAGE_OUTPUT_WIDTH, IMAGE_OUTPUT_HEIGHT, IMAGE_CHANNEL_BGRA, capture->wayland_buf->mem);
+        if (0 != ret)
+        {
+            fprintf(stderr, "[ERROR] Failed to initialize Image object.\n");
+            ret_main = ret;
+            goto end_close_camera;
+        }
+#ifdef CAM_INPUT_VGA
+        /* Paint the letterbox border of the display buffers. */
+        ret = img.init_upscale(CAM_RESIZED_WIDTH, CAM_RESIZED_HEIGHT);
+        if (0 != ret)
+        {
+            fprintf(stderr, "[ERROR] Failed to initialize Image object.\n");
+            ret_main = ret;
+            goto end_close_camera;
+        }
+#endif // CAM_INPUT_VGA
+#if (1) == DISP_OVERLAY_MODE
+        /* Allocate the overlay buffers. */
+        ret = img.init_overlay(CAM_RESIZED_WIDTH, CAM_RESIZED_HEIGHT);
+        if (0 != ret)
+        {
+            fprintf(stderr, "[ERROR] Failed to initialize Image object.\n");
+            ret_main = ret;
+            goto end_close_camera;
+        }
+#endif
     }
     
     /*Termination Request Semaphore Initialization*/
@@ -1420,6 +2078,17 @@ int32_t main(int32_t argc, char * argv[])
         ret_main = -1;
         goto end_threads;
     }
+    ret = init_events();
+    if (0 != ret)
+    {
+        fprintf(stderr, "[ERROR] Failed to Initialize Events.\n");
+        ret_main = -1;
+        goto end_threads;
+    }
+#if (1) == FRAME_TRACE_MODE
+    /* Export the frame trace on "kill -USR1 <pid>". SIGUSR1 is blocked at the top of main(). */
+    signal(SIGUSR1, trace_signal_handler);
+#endif
 
     /*Create Key Hit Thread*/
     create_thread_key = pthread_create(&kbhit_thread, NULL, R_Kbhit_Thread, NULL);
@@ -1434,41 +2103,71 @@ int32_t main(int32_t argc, char * argv[])
     create_thread_ai = pthread_create(&ai_inf_thread, NULL, R_Inf_Thread, NULL);
     if (0 != create_thread_ai)
     {
-        sem_trywait(&terminate_req_sem);
+        request_terminate();
         fprintf(stderr, "[ERROR] Failed to create AI Inference Thread.\n");
         ret_main = -1;
         goto end_threads;
     }
 
+    /*Create Post-processing Thread*/
+    create_thread_post = pthread_create(&post_thread, NULL, R_Post_Thread, NULL);
+    if (0 != create_thread_post)
+    {
+        request_terminate();
+        fprintf(stderr, "[ERROR] Failed to create Post-processing Thread.\n");
+        ret_main = -1;
+        goto end_threads;
+    }
+
     /*Create Capture Thread*/
     create_thread_capture = pthread_create(&capture_thread, NULL, R_Capture_Thread, (void *) capture);
     if (0 != create_thread_capture)
     {
-        sem_trywait(&terminate_req_sem);
+        request_terminate();
         fprintf(stderr, "[ERROR] Failed to create Capture Thread.\n");
         ret_main = -1;
         goto end_threads;
     }
 
-    /*Create Image Thread*/
-    create_thread_img = pthread_create(&img_thread, NULL, R_Img_Thread, NULL);
-    if(0 != create_thread_img)
+    /*Image Thread and Display Thread are not created in the headless mode.*/
+    if (!headless)
     {
-        sem_trywait(&terminate_req_sem);
-        fprintf(stderr, "[ERROR] Failed to create Image Thread.\n");
-        ret_main = -1;
-        goto end_threads;
+        /*Create Image Thread*/
+        create_thread_img = pthread_create(&img_thread, NULL, R_Img_Thread, NULL);
+        if(0 != create_thread_img)
+        {
+            request_terminate();
+            fprintf(stderr, "[ERROR] Failed to create Image Thread.\n");
+            ret_main = -1;
+            goto end_threads;
+        }
+
+        /*Create Display Thread*/
+        create_thread_hdmi = pthread_create(&hdmi_thread, NULL, R_Display_Thread, NULL);
+        if(0 != create_thread_hdmi)
+        {
+            request_terminate();
+            fprintf(stderr, "[ERROR] Failed to create Display Thread.\n");
+            ret_main = -1;
+            goto end_threads;
+        }
     }
 
-	/*Create Display Thread*/
-    create_thread_hdmi = pthread_create(&hdmi_thread, NULL, R_Display_Thread, NULL);
-    if(0 != create_thread_hdmi)
+#if (1) == METRICS_MODE
+    /*Create Metrics Thread. The application runs without the metrics if the socket is not available.*/
+    if (0 == metrics_server.open(METRICS_SOCKET_PATH))
     {
-        sem_trywait(&terminate_req_sem);
-        fprintf(stderr, "[ERROR] Failed to create Display Thread.\n");
-        ret_main = -1;
-        goto end_threads;
+        create_thread_metrics = pthread_create(&metrics_thread, NULL, R_Metrics_Thread, NULL);
+        if (0 != create_thread_metrics)
+        {
+            fprintf(stderr, "[WARNING] Failed to create Metrics Thread.\n");
+        }
+        else
+        {
+            printf("Metrics : %s\n", METRICS_SOCKET_PATH);
+        }
     }
+#endif
 #endif
 
     /*Main Processing*/
@@ -1519,6 +2218,15 @@ end_threads:
             ret_main = -1;
         }
     }
+    if (0 == create_thread_post)
+    {
+        ret = wait_join(&post_thread, AI_THREAD_TIMEOUT);
+        if (0 != ret)
+        {
+            fprintf(stderr, "[ERROR] Failed to exit Post-processing Thread on time.\n");
+            ret_main = -1;
+        }
+    }
     if (0 == create_thread_key)
     {
         ret = wait_join(&kbhit_thread, KEY_THREAD_TIMEOUT);
@@ -1528,15 +2236,70 @@ end_threads:
             ret_main = -1;
         }
     }
+#if (1) == METRICS_MODE
+    if (0 == create_thread_metrics)
+    {
+        ret = wait_join(&metrics_thread, KEY_THREAD_TIMEOUT);
+        if (0 != ret)
+        {
+            fprintf(stderr, "[ERROR] Failed to exit Metrics Thread on time.\n");
+            ret_main = -1;
+        }
+    }
+    metrics_server.close();
+#endif
 
     /*Delete Terminate Request Semaphore.*/
     if (0 == sem_create)
     {
         sem_destroy(&terminate_req_sem);
     }
+    terminate_event.close();
+    inference_event.close();
+    capture_event.close();
+    convert_event.close();
+#if (1) == FRAME_TRACE_MODE
+    signal(SIGUSR1, SIG_DFL);
+    trace_request_event.close();
+    frame_trace.export_json(FRAME_TRACE_FILE);
+#endif
+#if (1) == CAPTURE_ZERO_COPY_MODE
+    capture_share.close();
+#endif
 
     /* Exit waylad */
-    wayland.exit();
+    if (!headless)
+    {
+        wayland.exit();
+    }
+    {
+        frame_ring_stats_t stats = frame_ring.get_stats();
+        printf("Frame Ring : %lu captured, %lu displayed, %lu dropped (no slot %lu, before conversion %lu, before display %lu)\n",
+            (unsigned long)stats.captured, (unsigned long)stats.displayed,
+            (unsigned long)(stats.drop_no_slot + stats.drop_captured + stats.drop_converted),
+            (unsigned long)stats.drop_no_slot, (unsigned long)stats.drop_captured, (unsigned long)stats.drop_converted);
+    }
+    {
+        output_queue_stats_t stats = output_queue.get_stats();
+        printf("Output Queue : %lu frames post-processed, max depth %u, inference waited %lu times, post-processing waited %lu times\n",
+            (unsigned long)(stats.num_pushed - stats.depth), (unsigned int)stats.max_depth,
+            (unsigned long)stats.stall_push, (unsigned long)stats.stall_pop);
+    }
+    {
+        latency_snapshot_t snap;
+        uint32_t stage;
+        printf("Latency [ms]      count      p50      p99      max\n");
+        for (stage = 0; stage < LATENCY_STAGE_NUM; stage++)
+        {
+            latency_hist[stage].snapshot(&snap, false);
+            if (0 == snap.count)
+            {
+                continue;
+            }
+            printf("  %-10s %9lu %8.3f %8.3f %8.3f\n", LatencyHist::get_stage_name(stage), (unsigned long)snap.count,
+                LatencyHist::percentile(&snap, 50) / 1e6, LatencyHist::percentile(&snap, 99) / 1e6, snap.max / 1e6);
+        }
+    }
     goto end_close_camera;
 
 end_close_camera:
@@ -1555,6 +2318,23 @@ end_close_camera:
 #endif
 
 end_close_drpai:
+    output_queue.close();
+#if (1) == DET_SHM_MODE
+    /* Remove the detection shared memory. The readers can still read the frames already published. */
+    det_publisher.close();
+#endif
+#if (1) == DET_LOG_MODE
+    /* Write the records remaining in the ring and close the detection log. */
+    det_logger.close();
+    printf("Detection Log : %lu records written, %lu frames dropped\n",
+        (unsigned long)det_logger.get_num_written(), (unsigned long)det_logger.get_num_dropped_frame());
+#endif
+#if (1) == TENSOR_RECORD_MODE
+    /* Write the frames remaining in the ring and close the tensor record. */
+    tensor_recorder.close();
+    printf("Tensor Record : %lu frames written, %lu frames dropped\n",
+        (unsigned long)tensor_recorder.get_num_written(), (unsigned long)tensor_recorder.get_num_dropped());
+#endif
     /*Close DRP-AI Driver.*/
     if (0 < drpai_fd)
     {
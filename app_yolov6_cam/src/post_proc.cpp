@@ -0,0 +1,231 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : post_proc.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for metiuan Detection YOLOv6 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "post_proc.h"
+#include "fp16_convert.h"
+
+using namespace std;
+
+PostProc::PostProc()
+{
+    output_dfl80.resize(num_dfl80_out);
+    output_dfl40.resize(num_dfl40_out);
+    output_dfl20.resize(num_dfl20_out);
+    output_class80.resize(num_class80_out);
+    output_class40.resize(num_class40_out);
+    output_class20.resize(num_class20_out);
+    drpai_output_buf.resize(num_inf_out);
+}
+
+PostProc::~PostProc()
+{
+
+}
+
+/*****************************************
+* Function Name : get_output_buffer
+* Description   : Get the FP32 buffer to which the DRP-AI output is copied.
+*                 The output is identified by the number of elements.
+* Arguments     : output_size = number of elements of the output
+* Return value  : address of the buffer
+*                 NULL if the output is not used
+******************************************/
+float* PostProc::get_output_buffer(int64_t output_size)
+{
+    switch (output_size)
+    {
+        case num_dfl80_out:
+            return output_dfl80.data();
+        case num_dfl40_out:
+            return output_dfl40.data();
+        case num_dfl20_out:
+            return output_dfl20.data();
+        case num_class80_out:
+            return output_class80.data();
+        case num_class40_out:
+            return output_class40.data();
+        case num_class20_out:
+            return output_class20.data();
+        default:
+            return NULL;
+    }
+}
+
+/*****************************************
+* Function Name : set_outputs
+* Description   : Copy DRP-AI outputs to the FP32 buffers.
+*                 The output buffer is selected once per output and
+*                 FP16 outputs are converted by float16_to_float32_array.
+* Arguments     : outputs = tuples of { data type, address of output data, number of elements }
+*                 num_output = number of outputs
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t PostProc::set_outputs(const std::tuple<InOutDataType, void*, int64_t>* outputs, int32_t num_output)
+{
+    int8_t ret = 0;
+    int32_t i = 0;
+    int64_t output_size;
+    float* dst = NULL;
+
+    for (i = 0; i < num_output; i++)
+    {
+        output_size = std::get<2>(outputs[i]);
+        dst = get_output_buffer(output_size);
+        if (NULL == dst)
+        {
+            continue;
+        }
+
+        /*Output Data Type = std::get<0>(outputs[i])*/
+        if (InOutDataType::FLOAT16 == std::get<0>(outputs[i]))
+        {
+            /*Output Data = std::get<1>(outputs[i])*/
+            const uint16_t* data_ptr = reinterpret_cast<const uint16_t*>(std::get<1>(outputs[i]));
+            /*FP16 to FP32 conversion*/
+            float16_to_float32_array(data_ptr, dst, output_size);
+        }
+        else if (InOutDataType::FLOAT32 == std::get<0>(outputs[i]))
+        {
+            /*Output Data = std::get<1>(outputs[i])*/
+            const float* data_ptr = reinterpret_cast<const float*>(std::get<1>(outputs[i]));
+            memcpy(dst, data_ptr, output_size * sizeof(float));
+        }
+        else
+        {
+            fprintf(stderr, "[ERROR] Output data type : not floating point.\n");
+            ret = -1;
+            break;
+        }
+    }
+    return ret;
+}
+
+/*****************************************
+* Function Name : get_shape
+* Description   : Get the shape of the DRP-AI output.
+*                 The output is identified by the number of elements.
+* Arguments     : size = number of elements of the output
+*                 shape = shape (N, C, H, W) of the output
+* Return value  : 0 if succeeded
+*                 not 0 if the output is not used
+******************************************/
+int8_t PostProc::get_shape(int64_t size, int32_t* shape)
+{
+    for (int32_t n = 0; n < NUM_INF_OUT_LAYER; n++)
+    {
+        int32_t grid = num_grids[n];
+        shape[0] = 1;
+        shape[2] = grid;
+        shape[3] = grid;
+        if (size == (REG_MAX * 4) * grid * grid)
+        {
+            shape[1] = REG_MAX * 4;
+            return 0;
+        }
+        if (size == NUM_CLASS * grid * grid)
+        {
+            shape[1] = NUM_CLASS;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/*****************************************
+* Function Name : dfl_proc
+* Description   : DFL process of the DRP-AI outputs.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void PostProc::dfl_proc()
+{
+    dfl.DFL_Proc(output_dfl80.data(), output_dfl40.data(), output_dfl20.data(),
+        output_class80.data(), output_class40.data(), output_class20.data(), drpai_output_buf.data());
+}
+
+/*****************************************
+* Function Name : decode
+* Description   : Process CPU post-processing for Yolov6
+* Arguments     : det_buff = detections over the threshold in DRP-AI input size
+* Return value  : -
+******************************************/
+void PostProc::decode(vector<detection>& det_buff)
+{
+    const float* floatarr = drpai_output_buf.data();
+    uint32_t i = 0;
+    uint32_t j = 0;
+    float score = 0;
+    float probability = 0;
+    float center_x = 0;
+    float center_y = 0;
+    float box_w = 0;
+    float box_h = 0;
+    int32_t pred_class = -1;
+    detection d;
+
+    float predictions[num_grid_points][NUM_CLASS + 4];
+
+    /* Convert 2D array and Transpose */
+    for (j = 0; j < NUM_CLASS + 4; j++)
+    {
+        for (i = 0; i < num_grid_points; i++)
+        {
+            predictions[i][j] = floatarr[j * num_grid_points + i];
+        }
+    }
+
+    det_buff.clear();
+    for (i = 0; i < num_grid_points; i++)
+    {
+	float max_pred = 0;
+        for (j = 0; j < NUM_CLASS; j++)
+        {
+            score = predictions[i][j + 4];
+            if (score > max_pred)
+            {
+                pred_class = j;
+                max_pred = score;
+            }
+        }
+        probability = max_pred;
+        if (probability > TH_PROB)
+        {
+            float scale_x = (float)DRPAI_IN_WIDTH / (float)MODEL_IN_W;
+            float scale_y = (float)DRPAI_IN_HEIGHT / (float)MODEL_IN_H;
+
+
+            center_x = predictions[i][0] * scale_x;
+            center_y = predictions[i][1] * scale_y;
+            box_w = predictions[i][2] * scale_x;
+            box_h = predictions[i][3] * scale_y;
+
+            Box bb = {center_x, center_y, box_w, box_h};
+            d = {bb, pred_class, probability};
+            det_buff.push_back(d);
+        }
+    }
+    return;
+}
+
+/*****************************************
+* Function Name : nms_proc
+* Description   : Apply NMS to the detections.
+* Arguments     : det_buff = detections over the threshold in DRP-AI input size
+* Return value  : -
+******************************************/
+void PostProc::nms_proc(vector<detection>& det_buff)
+{
+    /* Non-Maximum Supression filter */
+    nms.NMS_Proc(det_buff, TH_NMS, DRPAI_IN_WIDTH, DRPAI_IN_HEIGHT);
+    return;
+}
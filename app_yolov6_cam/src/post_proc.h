@@ -0,0 +1,62 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : post_proc.h
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for metiuan Detection YOLOv6 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+#ifndef POST_PROC_H
+#define POST_PROC_H
+
+#include "define.h"
+#include "dfl_proc_yolov6.h"
+#include "nms.h"
+#include <tuple>
+#ifdef POST_PROC_BENCH
+/* Host build of the offline benchmark (bench/) without DRP-AI TVM[*1] Runtime.
+   Same as InOutDataType of MeraDrpRuntimeWrapper.h */
+enum class InOutDataType
+{
+    FLOAT32,
+    FLOAT16,
+    OTHER
+};
+#else
+/*DRP-AI TVM[*1] Runtime*/
+#include "MeraDrpRuntimeWrapper.h"
+#endif
+
+/* CPU post-processing chain of DRP-AI output.
+   set_outputs -> dfl_proc -> decode -> nms_proc
+   Used by the application and the offline benchmark (bench/). */
+class PostProc
+{
+    public:
+        PostProc();
+        ~PostProc();
+
+        int8_t set_outputs(const std::tuple<InOutDataType, void*, int64_t>* outputs, int32_t num_output);
+        void dfl_proc();
+        void decode(std::vector<detection>& det_buff);
+        void nms_proc(std::vector<detection>& det_buff);
+        int8_t get_shape(int64_t size, int32_t* shape);
+
+    private:
+        float* get_output_buffer(int64_t output_size);
+
+        /* FP32 copy of DRP-AI output */
+        std::vector<float> output_dfl80;
+        std::vector<float> output_dfl40;
+        std::vector<float> output_dfl20;
+        std::vector<float> output_class80;
+        std::vector<float> output_class40;
+        std::vector<float> output_class20;
+        /* Output of DFL_Proc (4 + NUM_CLASS, num_grid_points) */
+        std::vector<float> drpai_output_buf;
+        DFL dfl;
+        NMS nms;
+};
+
+#endif
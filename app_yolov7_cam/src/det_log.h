@@ -0,0 +1,135 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : det_log.h
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for WongKinYu YOLOV7 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+#ifndef DET_LOG_H
+#define DET_LOG_H
+
+#include "define.h"
+#include "event.h"
+#include <string>
+#include <thread>
+
+/*****************************************
+* Detection log file
+*  [det_log_header]
+*  [record 0] [record 1] ...
+*  Each record is header.record_size bytes (det_log_record_t).
+*  The boxes of a frame are followed by the frame record of the frame.
+*  A frame is written with all of its boxes or not at all.
+*  header.num_dropped_frame is updated when the log is closed.
+******************************************/
+#define DET_LOG_MAGIC               "DRPAIDET"
+#define DET_LOG_VERSION             (1)
+
+/* det_log_record_t.type */
+#define DET_LOG_BOX                 (0)
+#define DET_LOG_FRAME               (1)
+
+typedef struct det_log_header
+{
+    char magic[8];              /* DET_LOG_MAGIC */
+    uint32_t version;           /* DET_LOG_VERSION */
+    uint32_t record_size;       /* sizeof(det_log_record_t) */
+    uint64_t num_dropped_frame; /* frames dropped because the ring was full */
+} det_log_header;
+
+typedef struct det_log_record
+{
+    uint32_t type;              /* DET_LOG_BOX or DET_LOG_FRAME */
+    uint32_t reserved;
+    uint64_t frame_id;          /* capture frame ID of the input image */
+    union
+    {
+        /* One detection after NMS */
+        struct
+        {
+            uint32_t cls;       /* class */
+            float prob;         /* probability */
+            float x;            /* center of the box in the DRP-AI input size */
+            float y;
+            float w;            /* size of the box in the DRP-AI input size */
+            float h;
+        } box;
+        /* End of the detections of the frame */
+        struct
+        {
+            uint64_t frame_no;  /* inference count */
+            int64_t capture_time;   /* capture time of the input image [ns] (CLOCK_REALTIME) */
+            float pre_time;     /* pre-processing time [ms] */
+            float inf_time;     /* inference time [ms] */
+            float post_time;    /* post-processing time [ms] */
+            uint32_t num_box;   /* number of the detections */
+        } frame;
+    };
+} det_log_record_t;
+
+class DetLogReader
+{
+    public:
+        DetLogReader();
+        ~DetLogReader();
+
+        int8_t open(const std::string& path);
+        void close();
+        uint64_t get_num_record();
+        uint64_t get_num_dropped_frame();
+        const det_log_record_t* get_record(uint64_t index);
+
+    private:
+        uint8_t* map_addr;
+        uint64_t map_size;
+        const det_log_header* header;
+        uint64_t num_record;
+};
+
+/* Writes the detections and the time of each stage to the detection log file.
+   push_box() and push_frame() copy a record to a lock-free ring on the caller thread (single producer),
+   and the writer thread appends the records to the file in batches.
+   begin_frame() reserves the ring for the boxes and the frame record of a frame before they are pushed,
+   so that a frame is dropped as a whole when the ring is full. */
+class DetLogger
+{
+    public:
+        DetLogger();
+        ~DetLogger();
+
+        int8_t open(const std::string& path, uint32_t num_record, int32_t interval);
+        int8_t begin_frame(uint32_t num_box);
+        int8_t push_box(uint64_t frame_id, uint32_t cls, float prob, float x, float y, float w, float h);
+        int8_t push_frame(uint64_t frame_id, uint64_t frame_no, int64_t capture_time,
+            float pre_time, float inf_time, float post_time, uint32_t num_box);
+        void close();
+        uint64_t get_num_written();
+        uint64_t get_num_dropped_frame();
+
+    private:
+        int32_t fd;
+        /* Max time between two writes [ms] */
+        int32_t flush_interval;
+        /* Record (n & (ring.size() - 1)) holds the n-th pushed record. */
+        std::vector<det_log_record_t> ring;
+        std::atomic<uint64_t> head;
+        std::atomic<uint64_t> tail;
+        std::atomic<uint64_t> num_dropped_frame;
+        /* Set by begin_frame() when the ring has no room for the frame, cleared by push_frame() */
+        bool frame_dropped;
+        /* Set by the writer thread when the file cannot be written */
+        std::atomic<bool> failed;
+        /* Signaled by push when the ring is half full */
+        Event fill_event;
+        /* Signaled by close() */
+        Event stop_event;
+        std::thread writer;
+
+        int8_t push(const det_log_record_t& record);
+        void writer_loop();
+        int8_t flush();
+};
+
+#endif
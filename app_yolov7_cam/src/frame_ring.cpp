@@ -0,0 +1,269 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : frame_ring.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for WongKinYu YOLOV7 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "frame_ring.h"
+
+/* Layout of FrameRing::state */
+#define FRAME_STATE_BITS            (8)
+#define FRAME_STATE_MASK            ((1ULL << FRAME_STATE_BITS) - 1)
+
+static inline uint64_t make_word(uint64_t seq, uint32_t st)
+{
+    return (seq << FRAME_STATE_BITS) | st;
+}
+
+static inline uint32_t state_of(uint64_t word)
+{
+    return (uint32_t)(word & FRAME_STATE_MASK);
+}
+
+static inline uint64_t seq_of(uint64_t word)
+{
+    return word >> FRAME_STATE_BITS;
+}
+
+FrameRing::FrameRing()
+{
+    int32_t i;
+
+    for (i = 0; i < WL_BUF_NUM; i++)
+    {
+        state[i].store(make_word(0, FRAME_FREE));
+    }
+    num_captured.store(0);
+    num_converted.store(0);
+    num_displayed.store(0);
+    num_drop_no_slot.store(0);
+    num_drop_captured.store(0);
+    num_drop_converted.store(0);
+}
+
+FrameRing::~FrameRing()
+{
+
+}
+
+/*****************************************
+* Function Name : transit
+* Description   : Change the state of the slot if it still has the same state and the same frame.
+* Arguments     : slot = slot index
+*                 word = state and sequence number read from the slot
+*                 to = new state
+* Return value  : true if the state is changed
+******************************************/
+bool FrameRing::transit(int32_t slot, uint64_t word, uint32_t to)
+{
+    return state[slot].compare_exchange_strong(word, make_word(seq_of(word), to), std::memory_order_acq_rel);
+}
+
+/*****************************************
+* Function Name : find
+* Description   : Find the slot in the state with the newest or the oldest frame.
+* Arguments     : st = state of the slot
+*                 newest = true to find the newest frame, false to find the oldest frame
+*                 word = state and sequence number of the found slot
+* Return value  : slot index, -1 if no slot is in the state
+******************************************/
+int32_t FrameRing::find(uint32_t st, bool newest, uint64_t* word)
+{
+    int32_t found = -1;
+    uint64_t found_word = 0;
+    int32_t i;
+
+    for (i = 0; i < WL_BUF_NUM; i++)
+    {
+        uint64_t w = state[i].load(std::memory_order_acquire);
+        if (st != state_of(w))
+        {
+            continue;
+        }
+        if ((0 > found) || (newest ? (seq_of(w) > seq_of(found_word)) : (seq_of(w) < seq_of(found_word))))
+        {
+            found = i;
+            found_word = w;
+        }
+    }
+    *word = found_word;
+    return found;
+}
+
+/*****************************************
+* Function Name : take_newest
+* Description   : Take the newest frame in the ready state and release the older ones,
+*                 which are counted as dropped.
+* Arguments     : ready = state of the frames to be taken
+*                 busy = new state of the taken slot
+*                 drop = counter of the dropped frames
+* Return value  : slot index, -1 if no frame is ready
+******************************************/
+int32_t FrameRing::take_newest(uint32_t ready, uint32_t busy, std::atomic<uint64_t>& drop)
+{
+    int32_t slot = -1;
+    uint64_t word = 0;
+    uint64_t taken_seq = 0;
+    int32_t i;
+
+    /* The Capture Thread may take a CAPTURED slot back at the same time. */
+    do
+    {
+        slot = find(ready, true, &word);
+        if (0 > slot)
+        {
+            return -1;
+        }
+    } while (!transit(slot, word, busy));
+    taken_seq = seq_of(word);
+
+    /* The Capture Thread may store a newer frame to a slot at the same time.
+       Only the frame read here is released, since the state and the frame are compared at once. */
+    for (i = 0; i < WL_BUF_NUM; i++)
+    {
+        word = state[i].load(std::memory_order_acquire);
+        if ((i != slot) && (ready == state_of(word)) && (seq_of(word) < taken_seq)
+            && transit(i, word, FRAME_FREE))
+        {
+            drop++;
+        }
+    }
+    return slot;
+}
+
+/*****************************************
+* Function Name : acquire_capture
+* Description   : Get the slot to store the captured frame (Capture Thread).
+*                 When no slot is free, the oldest frame waiting for the conversion is overwritten.
+* Arguments     : -
+* Return value  : slot index, -1 if all slots are in use (the frame is dropped)
+******************************************/
+int32_t FrameRing::acquire_capture()
+{
+    int32_t slot;
+    uint64_t word = 0;
+    int32_t retry;
+
+    /* Only the Capture Thread takes FREE slots. */
+    slot = find(FRAME_FREE, false, &word);
+    if ((0 <= slot) && transit(slot, word, FRAME_CAPTURING))
+    {
+        return slot;
+    }
+    for (retry = 0; retry < WL_BUF_NUM; retry++)
+    {
+        slot = find(FRAME_CAPTURED, false, &word);
+        if (0 > slot)
+        {
+            break;
+        }
+        if (transit(slot, word, FRAME_CAPTURING))
+        {
+            num_drop_captured++;
+            return slot;
+        }
+    }
+    num_drop_no_slot++;
+    return -1;
+}
+
+/*****************************************
+* Function Name : publish_capture
+* Description   : Hand the captured frame over to the Image Thread.
+* Arguments     : slot = slot index returned by acquire_capture
+* Return value  : -
+******************************************/
+void FrameRing::publish_capture(int32_t slot)
+{
+    num_captured++;
+    state[slot].store(make_word(++last_seq, FRAME_CAPTURED), std::memory_order_release);
+}
+
+/*****************************************
+* Function Name : acquire_convert
+* Description   : Get the newest captured frame to be converted (Image Thread).
+* Arguments     : -
+* Return value  : slot index, -1 if no frame is captured
+******************************************/
+int32_t FrameRing::acquire_convert()
+{
+    return take_newest(FRAME_CAPTURED, FRAME_CONVERTING, num_drop_captured);
+}
+
+/*****************************************
+* Function Name : publish_convert
+* Description   : Hand the converted frame over to the Display Thread.
+* Arguments     : slot = slot index returned by acquire_convert
+* Return value  : -
+******************************************/
+void FrameRing::publish_convert(int32_t slot)
+{
+    num_converted++;
+    state[slot].store(make_word(seq_of(state[slot].load(std::memory_order_relaxed)), FRAME_CONVERTED),
+        std::memory_order_release);
+}
+
+/*****************************************
+* Function Name : acquire_display
+* Description   : Get the newest converted frame to be displayed (Display Thread).
+* Arguments     : -
+* Return value  : slot index, -1 if no frame is converted
+******************************************/
+int32_t FrameRing::acquire_display()
+{
+    return take_newest(FRAME_CONVERTED, FRAME_DISPLAYING, num_drop_converted);
+}
+
+/*****************************************
+* Function Name : release_display
+* Description   : Called after the slot is committed to Wayland.
+*                 The slot stays on the display, and the slot shown before is freed.
+* Arguments     : slot = slot index returned by acquire_display
+* Return value  : -
+******************************************/
+void FrameRing::release_display(int32_t slot)
+{
+    if ((0 <= on_screen) && (on_screen != slot))
+    {
+        state[on_screen].store(make_word(seq_of(state[on_screen].load(std::memory_order_relaxed)), FRAME_FREE),
+            std::memory_order_release);
+    }
+    on_screen = slot;
+    num_displayed++;
+}
+
+/*****************************************
+* Function Name : get_seq
+* Description   : Get the capture sequence number of the frame in the slot.
+* Arguments     : slot = slot index
+* Return value  : sequence number (1 for the first captured frame)
+******************************************/
+uint64_t FrameRing::get_seq(int32_t slot)
+{
+    return seq_of(state[slot].load(std::memory_order_relaxed));
+}
+
+/*****************************************
+* Function Name : get_stats
+* Description   : Get the frame counters.
+* Arguments     : -
+* Return value  : frame counters
+******************************************/
+frame_ring_stats_t FrameRing::get_stats()
+{
+    frame_ring_stats_t stats;
+
+    stats.captured = num_captured.load();
+    stats.converted = num_converted.load();
+    stats.displayed = num_displayed.load();
+    stats.drop_no_slot = num_drop_no_slot.load();
+    stats.drop_captured = num_drop_captured.load();
+    stats.drop_converted = num_drop_converted.load();
+    return stats;
+}
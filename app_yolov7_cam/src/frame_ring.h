@@ -0,0 +1,83 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : frame_ring.h
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for WongKinYu YOLOV7 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include "define.h"
+
+/*****************************************
+* Ownership state of a display buffer (slot)
+*  FREE -> CAPTURING -> CAPTURED -> CONVERTING -> CONVERTED -> DISPLAYING -> FREE
+*  Capture Thread : FREE/CAPTURED -> CAPTURING -> CAPTURED
+*  Image Thread   : CAPTURED -> CONVERTING -> CONVERTED
+*  Display Thread : CONVERTED -> DISPLAYING, and DISPLAYING -> FREE when the next slot is committed
+*  Only the thread that moved a slot out of FREE/CAPTURED/CONVERTED may touch its buffer.
+******************************************/
+enum frame_state : uint32_t
+{
+    FRAME_FREE = 0,
+    FRAME_CAPTURING,
+    FRAME_CAPTURED,
+    FRAME_CONVERTING,
+    FRAME_CONVERTED,
+    FRAME_DISPLAYING,
+};
+
+/* Frame counters. Every captured frame is displayed, dropped or still in a slot:
+   captured = displayed + drop_captured + drop_converted + (frames in the slots) */
+typedef struct frame_ring_stats
+{
+    uint64_t captured;          /* frames stored by the Capture Thread */
+    uint64_t converted;         /* frames converted by the Image Thread */
+    uint64_t displayed;         /* frames committed by the Display Thread */
+    uint64_t drop_no_slot;      /* camera frames not stored since no slot was available */
+    uint64_t drop_captured;     /* captured frames replaced by a newer frame before conversion */
+    uint64_t drop_converted;    /* converted frames replaced by a newer frame before display */
+} frame_ring_stats_t;
+
+/* Hands the display buffers over between the Capture, Image and Display Threads
+   with a lock-free state per slot. Each stage always takes the newest frame. */
+class FrameRing
+{
+    public:
+        FrameRing();
+        ~FrameRing();
+
+        int32_t acquire_capture();
+        void publish_capture(int32_t slot);
+        int32_t acquire_convert();
+        void publish_convert(int32_t slot);
+        int32_t acquire_display();
+        void release_display(int32_t slot);
+        uint64_t get_seq(int32_t slot);
+        frame_ring_stats_t get_stats();
+
+    private:
+        /* State (lower 8 bits) and capture sequence number of the frame (upper bits, 1, 2, ...) of each slot.
+           They are in one word so that a state change also checks that the frame in the slot is the same. */
+        std::atomic<uint64_t> state[WL_BUF_NUM];
+        /* Last sequence number. Written by the Capture Thread only. */
+        uint64_t last_seq = 0;
+        /* Slot shown on the display. Written by the Display Thread only. */
+        int32_t on_screen = -1;
+
+        std::atomic<uint64_t> num_captured;
+        std::atomic<uint64_t> num_converted;
+        std::atomic<uint64_t> num_displayed;
+        std::atomic<uint64_t> num_drop_no_slot;
+        std::atomic<uint64_t> num_drop_captured;
+        std::atomic<uint64_t> num_drop_converted;
+
+        bool transit(int32_t slot, uint64_t word, uint32_t to);
+        int32_t find(uint32_t st, bool newest, uint64_t* word);
+        int32_t take_newest(uint32_t ready, uint32_t busy, std::atomic<uint64_t>& drop);
+};
+
+#endif
@@ -0,0 +1,204 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : metrics_server.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for WongKinYu YOLOV7 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "metrics_server.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+
+MetricsServer::MetricsServer()
+{
+
+}
+
+MetricsServer::~MetricsServer()
+{
+    close();
+}
+
+/*****************************************
+* Function Name : open
+* Description   : Create the listening socket. An old socket file left at the path is removed.
+* Arguments     : socket_path = path of the Unix domain socket
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t MetricsServer::open(const char* socket_path)
+{
+    struct sockaddr_un addr;
+
+    if (strlen(socket_path) >= sizeof(addr.sun_path))
+    {
+        fprintf(stderr, "[ERROR] Metrics socket path is too long : %s\n", socket_path);
+        return -1;
+    }
+    errno = 0;
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (0 > fd)
+    {
+        fprintf(stderr, "[ERROR] Failed to create metrics socket : errno=%d\n", errno);
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+    unlink(socket_path);
+    errno = 0;
+    if ((0 != bind(fd, (struct sockaddr*)&addr, sizeof(addr))) || (0 != listen(fd, 4)))
+    {
+        fprintf(stderr, "[ERROR] Failed to listen on %s : errno=%d\n", socket_path, errno);
+        ::close(fd);
+        fd = -1;
+        return -1;
+    }
+    path = socket_path;
+    return 0;
+}
+
+/*****************************************
+* Function Name : close
+* Description   : Close the listening socket and remove the socket file.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void MetricsServer::close()
+{
+    if (0 <= fd)
+    {
+        ::close(fd);
+        fd = -1;
+        unlink(path.c_str());
+    }
+}
+
+/*****************************************
+* Function Name : get_fd
+* Description   : Get the listening socket to wait for a client.
+* Arguments     : -
+* Return value  : file descriptor, -1 if not opened
+******************************************/
+int32_t MetricsServer::get_fd()
+{
+    return fd;
+}
+
+/*****************************************
+* Function Name : serve
+* Description   : Accept a client, write the text and close the connection.
+*                 A client that does not read within METRICS_SEND_TIMEOUT is dropped.
+*                 Temporary accept failures are warned at most once per METRICS_WARNING_INTERVAL.
+* Arguments     : text = metrics snapshot
+* Return value  : METRICS_SERVE_OK if succeeded or no client is waiting
+*                 METRICS_SERVE_RETRY if the client cannot be accepted now
+*                 METRICS_SERVE_ERROR if the listening socket is not usable
+******************************************/
+int8_t MetricsServer::serve(const std::string& text)
+{
+    struct timeval timeout = { .tv_sec = METRICS_SEND_TIMEOUT, .tv_usec = 0 };
+    struct timespec now;
+    int32_t err = 0;
+    size_t sent = 0;
+    ssize_t ret;
+    int32_t client;
+
+    do
+    {
+        errno = 0;
+        client = accept4(fd, NULL, NULL, SOCK_CLOEXEC);
+    } while ((0 > client) && (EINTR == errno));
+    if (0 > client)
+    {
+        err = errno;
+        if ((EAGAIN == err) || (EWOULDBLOCK == err) || (ECONNABORTED == err))
+        {
+            /* The client has gone before accept. */
+            return METRICS_SERVE_OK;
+        }
+        if ((EBADF == err) || (ENOTSOCK == err) || (EINVAL == err) || (EOPNOTSUPP == err))
+        {
+            fprintf(stderr, "[ERROR] Metrics socket is not usable : errno=%d\n", err);
+            return METRICS_SERVE_ERROR;
+        }
+        /* EMFILE, ENFILE, ENOBUFS, ENOMEM, EPROTO, etc. The client is still waiting to be accepted. */
+        num_accept_error++;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (METRICS_WARNING_INTERVAL <= now.tv_sec - last_warning_time)
+        {
+            fprintf(stderr, "[WARNING] Failed to accept metrics client : errno=%d (%lu failures in total)\n",
+                err, (unsigned long)num_accept_error);
+            last_warning_time = now.tv_sec;
+        }
+        return METRICS_SERVE_RETRY;
+    }
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    while (sent < text.size())
+    {
+        /* MSG_NOSIGNAL: no SIGPIPE when the client has closed the connection. */
+        ret = send(client, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+        if (0 > ret)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            break;
+        }
+        sent += ret;
+    }
+    ::close(client);
+    return 0;
+}
+
+/*****************************************
+* Function Name : add_header
+* Description   : Append the HELP and TYPE lines of a metric.
+* Arguments     : out = metrics text
+*                 name = metric name
+*                 type = counter, gauge or summary
+*                 help = description
+* Return value  : -
+******************************************/
+void MetricsServer::add_header(std::string& out, const char* name, const char* type, const char* help)
+{
+    out += "# HELP ";
+    out += name;
+    out += " ";
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += " ";
+    out += type;
+    out += "\n";
+}
+
+/*****************************************
+* Function Name : add_value
+* Description   : Append a sample of a metric.
+* Arguments     : out = metrics text
+*                 name = metric name
+*                 labels = labels without braces (e.g. stage="pre"), NULL if none
+*                 value = value
+* Return value  : -
+******************************************/
+void MetricsServer::add_value(std::string& out, const char* name, const char* labels, double value)
+{
+    char buf[64];
+
+    out += name;
+    if ((NULL != labels) && ('\0' != labels[0]))
+    {
+        out += "{";
+        out += labels;
+        out += "}";
+    }
+    snprintf(buf, sizeof(buf), " %.12g\n", value);
+    out += buf;
+}
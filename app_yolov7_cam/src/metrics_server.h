@@ -0,0 +1,46 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : metrics_server.h
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for WongKinYu YOLOV7 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include "define.h"
+#include <string>
+
+/* Return values of MetricsServer::serve */
+#define METRICS_SERVE_OK            (0)     /* served, or no client is waiting */
+#define METRICS_SERVE_RETRY         (1)     /* the client could not be accepted now (e.g. out of file descriptors) */
+#define METRICS_SERVE_ERROR         (-1)    /* the listening socket is not usable */
+
+/* Unix domain socket that writes a metrics snapshot in the Prometheus text format
+   to each client and closes the connection. e.g. socat - UNIX-CONNECT:<path> */
+class MetricsServer
+{
+    public:
+        MetricsServer();
+        ~MetricsServer();
+
+        int8_t open(const char* socket_path);
+        void close();
+        int32_t get_fd();
+        int8_t serve(const std::string& text);
+
+        static void add_header(std::string& out, const char* name, const char* type, const char* help);
+        static void add_value(std::string& out, const char* name, const char* labels, double value);
+
+    private:
+        /* Listening socket, -1 if not opened */
+        int32_t fd = -1;
+        std::string path;
+        /* Temporary accept failures, and the time of the last warning of them [s] (CLOCK_MONOTONIC) */
+        uint64_t num_accept_error = 0;
+        int64_t last_warning_time = -METRICS_WARNING_INTERVAL;
+};
+
+#endif
@@ -0,0 +1,203 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : output_queue.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for WongKinYu YOLOV7 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "output_queue.h"
+
+OutputQueue::OutputQueue()
+{
+    head.store(0);
+    tail.store(0);
+    stall_push.store(0);
+    stall_pop.store(0);
+    max_depth.store(0);
+}
+
+OutputQueue::~OutputQueue()
+{
+    close();
+}
+
+/*****************************************
+* Function Name : init
+* Description   : Allocate the slots and create the events.
+*                 The output data of each slot is allocated at the first copy.
+* Arguments     : num_slot = number of slots (2 for double buffering)
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t OutputQueue::init(uint32_t num_slot)
+{
+    if (0 == num_slot)
+    {
+        return -1;
+    }
+    slots.resize(num_slot);
+    head.store(0);
+    tail.store(0);
+    if ((0 != free_event.init()) || (0 != ready_event.init()))
+    {
+        return -1;
+    }
+    return 0;
+}
+
+/*****************************************
+* Function Name : close
+* Description   : Close the events.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void OutputQueue::close()
+{
+    free_event.close();
+    ready_event.close();
+}
+
+/*****************************************
+* Function Name : acquire
+* Description   : Get the free slot to store the outputs of the next frame (AI Inference Thread).
+*                 Sleeps while all slots are waiting for the post-processing.
+* Arguments     : terminate = terminate event
+* Return value  : free slot
+*                 NULL if termination is requested
+******************************************/
+output_slot_t* OutputQueue::acquire(Event& terminate)
+{
+    uint64_t h = head.load(std::memory_order_relaxed);
+
+    if (h - tail.load(std::memory_order_acquire) >= slots.size())
+    {
+        stall_push++;
+        do
+        {
+            if (EVENT_SIGNALED != free_event.wait(terminate, -1))
+            {
+                return NULL;
+            }
+        } while (h - tail.load(std::memory_order_acquire) >= slots.size());
+    }
+    return &slots[h % slots.size()];
+}
+
+/*****************************************
+* Function Name : copy_outputs
+* Description   : Copy the DRP-AI outputs to the slot.
+* Arguments     : slot = slot returned by acquire
+*                 outputs = tuples of { data type, address of output data, number of elements }
+*                 num_output = number of outputs
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t OutputQueue::copy_outputs(output_slot_t* slot, const std::tuple<InOutDataType, void*, int64_t>* outputs, int32_t num_output)
+{
+    int32_t i;
+    size_t elem_size;
+
+    slot->data.resize(num_output);
+    slot->outputs.resize(num_output);
+    for (i = 0; i < num_output; i++)
+    {
+        if (InOutDataType::FLOAT32 == std::get<0>(outputs[i]))
+        {
+            elem_size = sizeof(float);
+        }
+        else if (InOutDataType::FLOAT16 == std::get<0>(outputs[i]))
+        {
+            elem_size = sizeof(uint16_t);
+        }
+        else
+        {
+            fprintf(stderr, "[ERROR] Output data type : not floating point number.\n");
+            return -1;
+        }
+        slot->data[i].resize(std::get<2>(outputs[i]) * elem_size);
+        memcpy(slot->data[i].data(), std::get<1>(outputs[i]), slot->data[i].size());
+        slot->outputs[i] = std::make_tuple(std::get<0>(outputs[i]), (void*)slot->data[i].data(), std::get<2>(outputs[i]));
+    }
+    return 0;
+}
+
+/*****************************************
+* Function Name : push
+* Description   : Hand the slot returned by acquire over to the Post-processing Thread.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void OutputQueue::push()
+{
+    uint64_t h = head.load(std::memory_order_relaxed) + 1;
+    uint32_t depth = (uint32_t)(h - tail.load(std::memory_order_acquire));
+
+    head.store(h, std::memory_order_release);
+    if (depth > max_depth.load(std::memory_order_relaxed))
+    {
+        max_depth.store(depth, std::memory_order_relaxed);
+    }
+    ready_event.signal();
+}
+
+/*****************************************
+* Function Name : front
+* Description   : Get the oldest frame to be post-processed (Post-processing Thread).
+*                 Sleeps while no frame is pushed.
+* Arguments     : terminate = terminate event
+* Return value  : slot of the frame
+*                 NULL if termination is requested
+******************************************/
+output_slot_t* OutputQueue::front(Event& terminate)
+{
+    uint64_t t = tail.load(std::memory_order_relaxed);
+
+    if (t == head.load(std::memory_order_acquire))
+    {
+        stall_pop++;
+        do
+        {
+            if (EVENT_SIGNALED != ready_event.wait(terminate, -1))
+            {
+                return NULL;
+            }
+        } while (t == head.load(std::memory_order_acquire));
+    }
+    return &slots[t % slots.size()];
+}
+
+/*****************************************
+* Function Name : pop
+* Description   : Release the slot returned by front after the post-processing.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void OutputQueue::pop()
+{
+    tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    free_event.signal();
+}
+
+/*****************************************
+* Function Name : get_stats
+* Description   : Get the queue depth and the stall counters.
+* Arguments     : -
+* Return value  : queue statistics
+******************************************/
+output_queue_stats_t OutputQueue::get_stats()
+{
+    output_queue_stats_t stats;
+    uint64_t h = head.load();
+
+    stats.num_pushed = h;
+    stats.stall_push = stall_push.load();
+    stats.stall_pop = stall_pop.load();
+    stats.depth = (uint32_t)(h - tail.load());
+    stats.max_depth = max_depth.load();
+    return stats;
+}
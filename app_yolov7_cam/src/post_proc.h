@@ -0,0 +1,38 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : post_proc.h
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for WongKinYu Detection YOLOv7 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+#ifndef POST_PROC_H
+#define POST_PROC_H
+
+#include "define.h"
+#include "tensor_view.h"
+#include "nms.h"
+
+/* CPU post-processing chain of DRP-AI output.
+   set_outputs -> decode -> nms_proc
+   Used by the application and the offline benchmark (bench/). */
+class PostProc
+{
+    public:
+        PostProc();
+        ~PostProc();
+
+        int8_t set_outputs(const std::tuple<InOutDataType, void*, int64_t>* outputs, int32_t num_output);
+        void decode(std::vector<detection>& det_buff);
+        void nms_proc(std::vector<detection>& det_buff);
+        const tensor_view* get_view(int64_t size);
+        uint64_t get_argmax_time();
+
+    private:
+        /* Views of DRP-AI output (80, 40, 20 grids) */
+        tensor_view output_layer[NUM_INF_OUT_LAYER];
+        NMS nms;
+};
+
+#endif
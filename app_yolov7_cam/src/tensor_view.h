@@ -0,0 +1,46 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : tensor_view.h
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for WongKinYu Detection YOLOv7 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+#ifndef TENSOR_VIEW_H
+#define TENSOR_VIEW_H
+
+#include "define.h"
+#include <tuple>
+#ifdef POST_PROC_BENCH
+/* Host build of the offline benchmark (bench/) without DRP-AI TVM[*1] Runtime.
+   Same as InOutDataType of MeraDrpRuntimeWrapper.h */
+enum class InOutDataType
+{
+    FLOAT32,
+    FLOAT16,
+    OTHER
+};
+#else
+/*DRP-AI TVM[*1] Runtime*/
+#include "MeraDrpRuntimeWrapper.h"
+#endif
+
+/* View of one DRP-AI output tensor (N, C, H, W) placed in the DRP-AI output memory */
+typedef struct tensor_view
+{
+    InOutDataType dtype;        /* data type of the DRP-AI output */
+    const void* data;           /* DRP-AI output memory */
+    int64_t size;               /* number of elements */
+    int32_t shape[4];           /* N, C, H, W */
+    int64_t strides[4];         /* distance between two elements of each dimension (elements) */
+    float scale;                /* grid stride in model input size (MODEL_IN_W / W) */
+    const float* fp32;          /* FP32 data. DRP-AI output memory itself when dtype is FLOAT32,
+                                   staging otherwise. NULL if the conversion is not requested. */
+    std::vector<float> staging; /* FP32 copy of the FP16 output. Allocated at the first use. */
+} tensor_view;
+
+int8_t bind_tensor_view(tensor_view& view, const std::tuple<InOutDataType, void*, int64_t>& output,
+                        int32_t c, int32_t h, int32_t w, bool need_fp32);
+
+#endif
@@ -0,0 +1,18 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : class_argmax.h
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for Ultralytics Detection YOLOv8 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+#ifndef CLASS_ARGMAX_H
+#define CLASS_ARGMAX_H
+
+#include "define.h"
+
+void class_argmax(const float* cls, int64_t class_step, int32_t num_class, int32_t num_cell,
+                  float* max_score, int32_t* max_class);
+
+#endif
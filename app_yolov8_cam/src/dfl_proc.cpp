@@ -11,14 +11,34 @@
 * Includes
 ******************************************/
 #include "dfl_proc.h"
-#include <opencv2/opencv.hpp>
-#include <thread>
+#include "class_argmax.h"
 
 using namespace std;
 
+/*****************************************
+* Function Name : to_float
+* Description   : Read one element of the dfl array as float.
+* Arguments     : x = FP32 or FP16 element
+* Return value  : float value
+******************************************/
+static inline float to_float(float x)
+{
+    return x;
+}
+static inline float to_float(uint16_t x)
+{
+    return float16_to_float32(x);
+}
+
 DFL::DFL()
 {
+    /* Threshold for non-sigmoid value */
+    if (TH_PROB <= 0) { th_logit = -FLT_MAX; }
+    else if (TH_PROB >= 1) { th_logit = FLT_MAX; }
+    else { th_logit = logf( TH_PROB / (1.0f-TH_PROB) ); }
 
+    max_score.resize(num_grid_points);
+    max_class.resize(num_grid_points);
 }
 
 DFL::~DFL()
@@ -27,396 +47,290 @@ DFL::~DFL()
 }
 
 /*****************************************
-* Function Name : sigmoid
-* Description   : Helper function for YOLO Post Processing
-* Arguments     : x = input argument for the calculation
-* Return value  : sigmoid result of input x
+* Function Name : init
+* Description   : Start the worker threads for CPU DFL processing.
+*                 The threads are kept alive until the application ends.
+* Arguments     : -
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
 ******************************************/
-double DFL::sigmoid(double x)
+int8_t DFL::init()
 {
-    return 1.0/(1.0 + exp(-x));
+#if (1) == CPU_DFL_MULTI_THREAD
+    return pool.start(CPU_DFL_NUM_WORKER, cpu_dfl_worker_core);
+#else
+    return 0;
+#endif
 }
 
 /*****************************************
-* Function Name : softmax
-* Description   : Helper function for YOLO Post Processing
-* Arguments     : input = input array
-*                 size = size of input array
-* Return value  : softmax result of input array
+* Function Name : chunk_range
+* Description   : Get the grid cells of a scale processed in a chunk.
+*                 num_grid_points is split into CPU_DFL_NUM_CHUNK chunks of the same size,
+*                 so one chunk may cover the cells of two scales.
+* Arguments     : chunk = chunk number
+*                 n = index of num_grids[]
+*                 cell_start = first cell of the scale in the chunk
+*                 cell_end = last cell + 1 of the scale in the chunk
+* Return value  : true if the chunk has the cells of the scale
+*                 false otherwise
 ******************************************/
-void DFL::softmax(const float* input, int size, float* output) 
+bool DFL::chunk_range(uint32_t chunk, int32_t n, int32_t* cell_start, int32_t* cell_end)
 {
-    float max_val = *max_element(input, input + size);
-    float sum = 0.0;
-    
-    for (int i = 0; i < size; i++) 
-    {
-        output[i] = exp(input[i] - max_val);
-        sum += output[i];
-    }
+    uint32_t start = (uint32_t)((uint64_t)num_grid_points * chunk / CPU_DFL_NUM_CHUNK);
+    uint32_t end = (uint32_t)((uint64_t)num_grid_points * (chunk + 1) / CPU_DFL_NUM_CHUNK);
+    uint32_t scale_start = grid_offsets[n];
+    uint32_t scale_end = grid_offsets[n] + num_grids[n] * num_grids[n];
 
-    for (int i = 0; i < size; i++) 
+    start = max(start, scale_start);
+    end = min(end, scale_end);
+    if (start >= end)
     {
-        output[i] /= sum;
+        return false;
     }
+    *cell_start = start - scale_start;
+    *cell_end = end - scale_start;
+    return true;
 }
 
 /*****************************************
-* Function Name : stage_conv
+* Function Name : sigmoid
 * Description   : Helper function for YOLO Post Processing
-* Arguments     : input = input array
-*                 size = size of input array
-* Return value  : result of convolution
+* Arguments     : x = input argument for the calculation
+* Return value  : sigmoid result of input x
 ******************************************/
-float DFL::stage_conv(const float* input, int size) 
+double DFL::sigmoid(double x)
 {
-    float weight[16];
-    for (int i = 0; i < 16; i++) 
-    {
-        weight[i] = i;
-    }
-    
-    float result = 0.0;
-    for (int i = 0; i < size; i++) 
-    {
-        result += input[i] * weight[i];
-    }
-    
-    return result;
+    return 1.0/(1.0 + exp(-x));
 }
-    
+
 /*****************************************
-* Function Name : stage_add_0
+* Function Name : dfl_expectation
 * Description   : Helper function for YOLO Post Processing
-* Arguments     : arr = input array
-*                 h, w = array shape
-* Return value  : stage add result of input array
+*                 Softmax over the REG_MAX bins of one box side followed by
+*                 the expectation (the "stage" conv with the weights 0..REG_MAX-1).
+* Arguments     : input = address of the first bin of the box side (FP32 or FP16)
+*                 step = distance between two bins (number of cells of the scale)
+* Return value  : distance from the anchor point to the box side in grid unit
 ******************************************/
-float* DFL::stage_add_0(float* arr, int32_t h, int32_t w)
+template <typename T>
+float DFL::dfl_expectation(const T* input, int32_t step)
 {
-    float param[w];
-    for (int i = 0; i < w; i++)
+    float logit[REG_MAX];
+    float max_val = -FLT_MAX;
+    float sum = 0;
+    float acc = 0;
+
+    for (int32_t i = 0; i < REG_MAX; i++)
     {
-        param[i] = i + 0.5; // [0.5, 1.5, ... , ]
+        logit[i] = to_float(input[i * step]);
+        max_val = (logit[i] > max_val) ? logit[i] : max_val;
     }
-
-    float* result = new float[h * w];
-    for (int _h = 0; _h < h; _h++)
+    for (int32_t i = 0; i < REG_MAX; i++)
     {
-        for (int _w = 0; _w < w; _w++)
-        {
-            result[_h * w + _w] = arr[_h * w + _w] + param[_w];
-        }
+        float e = expf(logit[i] - max_val);
+        sum += e;
+        acc += e * i;
     }
-    return result;
+    return acc / sum;
 }
 
 /*****************************************
-* Function Name : stage_add_1
-* Description   : Helper function for YOLO Post Processing
-* Arguments     : arr = input array
-*                 h, w = array shape
-* Return value  : stage add result of input array
+* Function Name : decode_cell
+* Description   : DFL decoder for one grid cell.
+*                 Reads the (4 * REG_MAX) logits of the cell once and computes
+*                 the box from the distance to the left, top, right and bottom side.
+* Arguments     : dfl_arr = dfl array (4 * REG_MAX, grid, grid) (FP32 or FP16)
+*                 grid = number of grids of the scale
+*                 cell = grid cell in the scale (y * grid + x)
+*                 box = center x, center y, width, height in model input size
+* Return value  : -
 ******************************************/
-float* DFL::stage_add_1(float* arr, int32_t h, int32_t w)
+template <typename T>
+void DFL::decode_cell(const T* dfl_arr, int32_t grid, int32_t cell, float* box)
 {
-    float param = 0.5;
-    float* result = new float[h * w];
-    for (int _h = 0; _h < h; _h++) 
-    {
-        for (int _w = 0; _w < w; _w++)
-        {
-            result[_h * w + _w] = arr[_h * w + _w] + param;
-        } 
-        param += 1;
-    }
-    return result;
+    int32_t hw = grid * grid;
+    float stride = (float)(MODEL_IN_W / grid);
+    /* Distance to the left, top, right and bottom side (ltrb) */
+    float l = dfl_expectation(dfl_arr + (0 * REG_MAX * hw) + cell, hw);
+    float t = dfl_expectation(dfl_arr + (1 * REG_MAX * hw) + cell, hw);
+    float r = dfl_expectation(dfl_arr + (2 * REG_MAX * hw) + cell, hw);
+    float b = dfl_expectation(dfl_arr + (3 * REG_MAX * hw) + cell, hw);
+    /* Anchor point is the center of the cell */
+    float x1 = ((cell % grid) + 0.5f) - l;
+    float y1 = ((cell / grid) + 0.5f) - t;
+    float x2 = ((cell % grid) + 0.5f) + r;
+    float y2 = ((cell / grid) + 0.5f) + b;
+
+    box[0] = ((x1 + x2) / 2) * stride;
+    box[1] = ((y1 + y2) / 2) * stride;
+    box[2] = (x2 - x1) * stride;
+    box[3] = (y2 - y1) * stride;
 }
 
 /*****************************************
-* Function Name : stage_sub_0
-* Description   : Helper function for YOLO Post Processing
-* Arguments     : arr = input array
-*                 h, w = array shape
-* Return value  : stage sub result of input array
+* Function Name : decode_dfl
+* Description   : Fused DFL decoder for the grid cells of one scale.
+*                 Writes the box of each grid cell straight to the rows 0-3
+*                 of the (4 + NUM_CLASS, num_grid_points) output layout.
+* Arguments     : dfl_arr = dfl array (4 * REG_MAX, grid, grid)
+*                 grid = number of grids of the scale
+*                 grid_offset = index of the first cell of the scale in num_grid_points
+*                 cell_start, cell_end = range of the grid cells to be decoded
+*                 output_buf = output array
+* Return value  : -
 ******************************************/
-float* DFL::stage_sub_0(float* arr, int32_t h, int32_t w)
+void DFL::decode_dfl(const float* dfl_arr, int32_t grid, uint32_t grid_offset, int32_t cell_start, int32_t cell_end, float* output_buf)
 {
-    float param[w];
-    for (int i = 0; i < w; i++)
-    {
-        param[i] = i + 0.5; // [0.5, 1.5, ... , ]
-    }
+    float box[4];
 
-    float* result = new float[h * w];
-    for (int _h = 0; _h < h; _h++)
+    for (int32_t cell = cell_start; cell < cell_end; cell++)
     {
-        for (int _w = 0; _w < w; _w++)
+        decode_cell(dfl_arr, grid, cell, box);
+        for (int32_t k = 0; k < 4; k++)
         {
-            result[_h * w + _w] = param[_w] - arr[_h * w + _w];
+            output_buf[k * num_grid_points + grid_offset + cell] = box[k];
         }
     }
-    return result;
 }
 
 /*****************************************
-* Function Name : stage_sub_1
-* Description   : Helper function for YOLO Post Processing
-* Arguments     : arr = input array
-*                 h, w = array shape
-* Return value  : stage sub result of input array
+* Function Name : sigmoid_process
+* Description   : Writes the class scores of the grid cells of one scale to the rows
+*                 4-(4 + NUM_CLASS - 1) of the (4 + NUM_CLASS, num_grid_points) output layout.
+* Arguments     : cls = class array (NUM_CLASS, grid, grid)
+*                 grid = number of grids of the scale
+*                 grid_offset = index of the first cell of the scale in num_grid_points
+*                 cell_start, cell_end = range of the grid cells to be processed
+*                 output_buf = output array
+* Return value  : -
 ******************************************/
-float* DFL::stage_sub_1(float* arr, int32_t h, int32_t w)
+void DFL::sigmoid_process(const float* cls, int32_t grid, uint32_t grid_offset, int32_t cell_start, int32_t cell_end, float* output_buf)
 {
-    float param = 0.5;
-    float* result = new float[h * w];
-    for (int _h = 0; _h < h; _h++) 
+    int32_t hw = grid * grid;
+
+    for (int32_t c = 0; c < NUM_CLASS; c++)
     {
-        for (int _w = 0; _w < w; _w++)
+        const float* in = cls + c * hw;
+        float* out = output_buf + (4 + c) * num_grid_points + grid_offset;
+#if (1) <= CPU_DFL_SIGMOID_SKIP
+        copy(in + cell_start, in + cell_end, out + cell_start);
+#else
+        for (int32_t i = cell_start; i < cell_end; i++)
         {
-            result[_h * w + _w] = param - arr[_h * w + _w];
-        } 
-        param += 1;
+            out[i] = sigmoid(in[i]);
+        }
+#endif
     }
-    return result;
 }
 
 /*****************************************
-* Function Name : split_dfl
-* Description   : Helper function for YOLO Post Processing
-* Arguments     : dfl_arr = input array
-*                 arr_size = size of input array
-* Return value  : split result of input array
+* Function Name : scan_class
+* Description   : Threshold processing on the class array of one scale in logit space.
+*                 The max score and class of each grid cell are computed by class_argmax,
+*                 then the cells over th_logit are listed.
+* Arguments     : cls = class array (NUM_CLASS, grid, grid)
+*                 scale = index of num_grids[]
+*                 cell_start, cell_end = range of the grid cells to be processed
+*                 candidates = list to which the cells over the threshold are added
+* Return value  : -
 ******************************************/
-float* DFL::split_dfl(float* dfl_arr, int32_t arr_size)
+void DFL::scan_class(const float* cls, uint8_t scale, int32_t cell_start, int32_t cell_end, vector<dfl_candidate>& candidates)
 {
-    int32_t c = 64;
-    int32_t h = 0;
-    int32_t w = 0;
+    int32_t hw = num_grids[scale] * num_grids[scale];
+    float* score = max_score.data() + grid_offsets[scale];
+    int32_t* pred = max_class.data() + grid_offsets[scale];
+    dfl_candidate d;
 
-    if (arr_size == num_dfl80_out)
-    {
-        h = 80;
-        w = 80;
-    }
-    else if (arr_size == num_dfl40_out)
-    {
-        h = 40;
-        w = 40;
-    }
-    else if (arr_size == num_dfl20_out)
-    {
-        h = 20;
-        w = 20;
-    }
-
-    int32_t ch_unit = 16;
-    int32_t c_div = c / ch_unit;
+    class_argmax(cls + cell_start, hw, NUM_CLASS, cell_end - cell_start, score + cell_start, pred + cell_start);
 
-    /* Transpose (CHW to HWC) */
-    float* dfl_arr_t = new float[h * w * c];
-    for (int _h = 0; _h < h; _h++) 
+    for (int32_t i = cell_start; i < cell_end; i++)
     {
-        for (int _w = 0; _w < w; _w++) 
+        if (score[i] > th_logit)
         {
-            for (int _c = 0; _c < c; _c++) 
-            {
-                dfl_arr_t[_h * w * c + _w * c + _c] = dfl_arr[_c * h * w + _h * w + _w];
-            }
+            d.scale = scale;
+            d.cell = (uint16_t)i;
+            d.c = pred[i];
+            d.score = score[i];
+            candidates.push_back(d);
         }
     }
+}
 
-    /* Softmax operation */
-    float* intm_1 = new float[h * w * c];
-    for (int _h = 0; _h < h; _h++) 
-    {
-        for (int _w = 0; _w < w; _w++) 
-        {
-            for (int _c = 0; _c < c_div; _c++) 
-            {
-                int idx = _c * ch_unit;
-                const float* input_ptr = dfl_arr_t + (_h * w * c + _w * c + idx);
-                float * output_ptr = intm_1 + (_h * w * c + _w * c + idx);
-                softmax(input_ptr, ch_unit, output_ptr);
-            }
-        }
-    }
-    delete[] dfl_arr_t;
+/*****************************************
+* Function Name : dense_chunk
+* Description   : process for thread
+*                 DFL and class scores of the grid cells in one chunk for DFL_Proc.
+* Arguments     : chunk = chunk number
+* Return value  : -
+******************************************/
+void DFL::dense_chunk(uint32_t chunk)
+{
+    int32_t cell_start = 0;
+    int32_t cell_end = 0;
 
-    /* "Stage" conv */
-    float* intm_2 = new float[h * w * c_div];
-    for (int _h = 0; _h < h; _h++) 
-    {
-        for (int _w = 0; _w < w; _w++) 
-        {
-            for (int _c = 0; _c < c_div; _c++) 
-            {
-                int idx = _c * ch_unit;
-                const float* input_ptr = intm_1 + (_h * w * c + _w * c + idx);
-                float _sc_out = stage_conv(input_ptr, ch_unit);
-                intm_2[_h * w * c_div + _w * c_div + _c] = _sc_out;
-            }
-        }
-    }
-    delete[] intm_1;
-
-    /* Split data */
-    float* intm_2_0 = new float[h * w];
-    float* intm_2_1 = new float[h * w];
-    float* intm_2_2 = new float[h * w];
-    float* intm_2_3 = new float[h * w];
-    for (int _h = 0; _h < h; _h++) 
+    for (int32_t n = 0; n < NUM_INF_OUT_LAYER; n++)
     {
-        for (int _w = 0; _w < w; _w++) 
+        if (chunk_range(chunk, n, &cell_start, &cell_end))
         {
-            intm_2_0[_h * w + _w] = intm_2[_h * w * c_div + _w * c_div + 0];
-            intm_2_1[_h * w + _w] = intm_2[_h * w * c_div + _w * c_div + 1];
-            intm_2_2[_h * w + _w] = intm_2[_h * w * c_div + _w * c_div + 2];
-            intm_2_3[_h * w + _w] = intm_2[_h * w * c_div + _w * c_div + 3];
+            decode_dfl(dfl_in[n], num_grids[n], grid_offsets[n], cell_start, cell_end, out_buf);
+            sigmoid_process(class_in[n], num_grids[n], grid_offsets[n], cell_start, cell_end, out_buf);
         }
     }
-    delete[] intm_2;
-
-    /* Add & Sub by fixed parameter */
-    float* intm_3_sub_0 = stage_sub_0(intm_2_0, h, w);
-    float* intm_3_sub_1 = stage_sub_1(intm_2_1, h, w);   
-    float* intm_3_add_0 = stage_add_0(intm_2_2, h, w);
-    float* intm_3_add_1 = stage_add_1(intm_2_3, h, w);
-    delete[] intm_2_0;
-    delete[] intm_2_1;
-    delete[] intm_2_2;
-    delete[] intm_2_3;
-
-    /* Add & Sub */
-    float* intm_4_add_out_0 = new float[h * w];
-    for (int i = 0; i < h * w; i++)
-    {
-        intm_4_add_out_0[i] = intm_3_sub_0[i] + intm_3_add_0[i];
-    } 
-    float* intm_4_add_out_1 = new float[h * w];
-    for (int i = 0; i < h * w; i++)
-    {
-        intm_4_add_out_1[i] = intm_3_sub_1[i] + intm_3_add_1[i];
-    }
-    float* intm_4_sub_out_0 = new float[h * w];
-    for (int i = 0; i < h * w; i++)
-    {
-        intm_4_sub_out_0[i] = intm_3_add_0[i] - intm_3_sub_0[i];
-    }
-    float* intm_4_sub_out_1 = new float[h * w];
-    for (int i = 0; i < h * w; i++)
-    {
-        intm_4_sub_out_1[i] = intm_3_add_1[i] - intm_3_sub_1[i];
-    }
-    delete[] intm_3_sub_0;
-    delete[] intm_3_sub_1;
-    delete[] intm_3_add_0;
-    delete[] intm_3_add_1;
-
-    /* Div & Mul */
-    int32_t div_val = 2;
-    int32_t mul_val = 0;
-    if (w == 20)
-    {
-        mul_val = 32;
-    }
-    else if (w == 40)
-    {
-        mul_val = 16;
-    }
-    else if (w == 80)
-    {
-        mul_val = 8;
-    }
-    
-    float* intm_5_add_0 = new float[h * w];
-    for (int i = 0; i < h * w; i++)
-    {
-        intm_5_add_0[i] = (intm_4_add_out_0[i] / div_val) * mul_val;
-    }
-    float* intm_5_add_1 = new float[h * w];
-    for (int i = 0; i < h * w; i++)
-    {
-        intm_5_add_1[i] = (intm_4_add_out_1[i] / div_val) * mul_val;
-    }
-    float* intm_5_sub_0 = new float[h * w];
-    for (int i = 0; i < h * w; i++)
-    {
-        intm_5_sub_0[i] = (intm_4_sub_out_0[i] / 1) * mul_val;
-    }
-    float* intm_5_sub_1 = new float[h * w];
-    for (int i = 0; i < h * w; i++)
-    {
-        intm_5_sub_1[i] = (intm_4_sub_out_1[i] / 1) * mul_val;
-    }
-    delete[] intm_4_add_out_0;
-    delete[] intm_4_add_out_1;
-    delete[] intm_4_sub_out_0;
-    delete[] intm_4_sub_out_1;
-
-    /* Concat */
-    int32_t final_channel = 4;
-    float* out = new float[h * w * final_channel];
-    for (int _h = 0; _h < h; _h++)
-    {
-        for (int _w = 0; _w < w; ++_w)
-        {
-            int idx = _h * w + _w;
-            out[idx * final_channel + 0] = intm_5_add_0[idx];
-            out[idx * final_channel + 1] = intm_5_add_1[idx];
-            out[idx * final_channel + 2] = intm_5_sub_0[idx];
-            out[idx * final_channel + 3] = intm_5_sub_1[idx];
-        }
-    }
-    delete[] intm_5_add_0;
-    delete[] intm_5_add_1;
-    delete[] intm_5_sub_0;
-    delete[] intm_5_sub_1;
-
-    /* HWC to CHW */
-    float* final_output = new float[final_channel * h * w];
-    for (int c = 0; c < final_channel; c++)
+}
+
+/*****************************************
+* Function Name : sparse_chunk
+* Description   : process for thread
+*                 Threshold processing of the grid cells in one chunk for DFL_Sparse_Proc.
+* Arguments     : chunk = chunk number
+* Return value  : -
+******************************************/
+void DFL::sparse_chunk(uint32_t chunk)
+{
+    int32_t cell_start = 0;
+    int32_t cell_end = 0;
+
+    chunk_candidates[chunk].clear();
+    for (int32_t n = 0; n < NUM_INF_OUT_LAYER; n++)
     {
-        for (int _h = 0; _h < h; _h++)
+        if (chunk_range(chunk, n, &cell_start, &cell_end))
         {
-            for (int _w = 0; _w < w; ++_w)
-            {
-                final_output[c * h * w + _h * w + _w] = out[_h * w * final_channel + _w * final_channel + c];
-            }
+            scan_class(class_in[n], n, cell_start, cell_end, chunk_candidates[chunk]);
         }
     }
-    delete[] out;
-
-    return final_output;
 }
 
 /*****************************************
-* Function Name : dfl_process
-* Description   : process for thread
-* Arguments     : -
+* Function Name : chunk_job
+* Description   : Job of the worker pool. Calls chunk_func of the DFL object for the chunk.
+* Arguments     : ctx = DFL object
+*                 chunk = chunk number
 * Return value  : -
 ******************************************/
-void DFL::dfl_process(float* dfl, uint32_t dfl_size, float* dfl_out)
+void DFL::chunk_job(void* ctx, uint32_t chunk)
 {
-    float* tmp = split_dfl(dfl, dfl_size);
-    copy(tmp, tmp + dfl_size/REG_MAX, dfl_out);
-    delete [] tmp;
+    DFL* dfl = (DFL*)ctx;
+
+    (dfl->*(dfl->chunk_func))(chunk);
 }
 
 /*****************************************
-* Function Name : sigmoid_process
-* Description   : process for thread
-* Arguments     : -
+* Function Name : run_chunks
+* Description   : Run the function for all chunks on the worker pool,
+*                 or on the caller thread when the multi-threading is disabled.
+* Arguments     : f = member function processing one chunk
 * Return value  : -
 ******************************************/
-void DFL::sigmoid_process(float* cls, uint32_t sigmoid_size, float* sigmoid_out)
+void DFL::run_chunks(void (DFL::*f)(uint32_t))
 {
-#if (1) <= CPU_DFL_SIGMOID_SKIP
-    copy(cls, cls + sigmoid_size, sigmoid_out);
+#if (1) == CPU_DFL_MULTI_THREAD
+    chunk_func = f;
+    pool.run(&DFL::chunk_job, this, CPU_DFL_NUM_CHUNK);
 #else
-    for (uint32_t i = 0; i < sigmoid_size; i++)
+    for (uint32_t chunk = 0; chunk < CPU_DFL_NUM_CHUNK; chunk++)
     {
-        sigmoid_out[i] = sigmoid(cls[i]);
+        (this->*f)(chunk);
     }
 #endif
 }
@@ -424,140 +338,66 @@ void DFL::sigmoid_process(float* cls, uint32_t sigmoid_size, float* sigmoid_out)
 /*****************************************
 * Function Name : DFL_Proc
 * Description   : DFL process for Yolov8
-* Arguments     : dfl80, dfl40, dfl20 = dfl array
-*                 class80, class40, class20 = class array
+* Arguments     : dfl = views of the dfl arrays (80, 40, 20 grids)
+*                 cls = views of the class arrays (80, 40, 20 grids)
+*                 output_buf = output array (4 + NUM_CLASS, num_grid_points)
 * Return value  : -
 ******************************************/
-void DFL::DFL_Proc(float* dfl80, float* dfl40, float* dfl20, float* class80, float* class40, float* class20, float* output_buf)
+void DFL::DFL_Proc(const tensor_view* dfl, const tensor_view* cls, float* output_buf)
 {
-    int32_t dfl_c = 4;
-        
-    /* DFL and Sigmoid operation */
-    float* dfl_out_80 = new float[num_dfl80_out/REG_MAX];
-    float* sigmoid_out_80 = new float[num_class80_out];
-    float* dfl_out_40 = new float[num_dfl40_out/REG_MAX];
-    float* sigmoid_out_40 = new float[num_class40_out];
-    float* dfl_out_20 = new float[num_dfl20_out/REG_MAX];
-    float* sigmoid_out_20 = new float[num_class20_out];
-
-#if (1) == CPU_DFL_MULTI_THREAD
-    thread thread_dfl_80(&DFL::dfl_process, this, dfl80, num_dfl80_out, dfl_out_80);
-    thread thread_sigmoid_80(&DFL::sigmoid_process, this, class80, num_class80_out, sigmoid_out_80);
-    thread thread_dfl_40(&DFL::dfl_process, this, dfl40, num_dfl40_out, dfl_out_40);
-    thread thread_sigmoid_40(&DFL::sigmoid_process, this, class40, num_class40_out, sigmoid_out_40);
-    thread thread_dfl_20(&DFL::dfl_process, this, dfl20, num_dfl20_out, dfl_out_20);
-    thread thread_sigmoid_20(&DFL::sigmoid_process, this, class20, num_class20_out, sigmoid_out_20);
-    thread_dfl_80.join();
-    thread_sigmoid_80.join();
-    thread_dfl_40.join();
-    thread_sigmoid_40.join();
-    thread_dfl_20.join();
-    thread_sigmoid_20.join();
-#else 
-    DFL::dfl_process(dfl80, num_dfl80_out, dfl_out_80);
-    DFL::dfl_process(dfl40, num_dfl40_out, dfl_out_40);
-    DFL::dfl_process(dfl20, num_dfl20_out, dfl_out_20);
-    DFL::sigmoid_process(class80, num_class80_out, sigmoid_out_80);
-    DFL::sigmoid_process(class40, num_class40_out, sigmoid_out_40);
-    DFL::sigmoid_process(class20, num_class20_out, sigmoid_out_20);
-#endif
-    
-    /* Reshape & Concat operation */
-    /* Reshape dfl out (4, 8400) */
-    float* dfl_all_out = new float[dfl_c * num_grid_points];
-    for (int c = 0; c < dfl_c; c++)
+    for (int32_t n = 0; n < NUM_INF_OUT_LAYER; n++)
     {
-        int32_t idx = 0;
-
-        /* dfl_out_80 */
-        for (int i = 0; i < num_grids[0]; i++)
-        {
-            for (int j = 0; j < num_grids[0]; j++)
-            {
-                dfl_all_out[c * num_grid_points + idx] = dfl_out_80[c * num_grids[0] * num_grids[0] + i * num_grids[0] + j];
-                idx++;
-            }
-        }
-        /* dfl_out_40 */
-        for (int i = 0; i < num_grids[1]; i++)
-        {
-            for (int j = 0; j < num_grids[1]; j++)
-            {
-                dfl_all_out[c * num_grid_points + idx] = dfl_out_40[c * num_grids[1] * num_grids[1] + i * num_grids[1] + j];
-                idx++;
-            }
-        }
-        /* dfl_out_20 */
-        for (int i = 0; i < num_grids[2]; i++)
-        {
-            for (int j = 0; j < num_grids[2]; j++)
-            {
-                dfl_all_out[c * num_grid_points + idx] = dfl_out_20[c * num_grids[2] * num_grids[2] + i * num_grids[2] + j];
-                idx++;
-            }
-        }
+        dfl_in[n] = dfl[n].fp32;
+        class_in[n] = cls[n].fp32;
     }
-    delete[] dfl_out_80;
-    delete[] dfl_out_40;
-    delete[] dfl_out_20;
+    out_buf = output_buf;
 
-    /* Reshape sigmoid out (80, 8400) */
-    float* sigmoid_all_out = new float[NUM_CLASS * num_grid_points];
-    for (int c = 0; c < NUM_CLASS; c++)
+    /* DFL and Sigmoid operation. Each chunk writes to its own columns of output_buf (4 + NUM_CLASS, 8400). */
+    run_chunks(&DFL::dense_chunk);
+
+    return;
+}
+
+/*****************************************
+* Function Name : DFL_Sparse_Proc
+* Description   : Candidate-first DFL process for Yolov8
+*                 Scans the class arrays in logit space first, then runs the DFL
+*                 only for the grid cells over the threshold.
+*                 The FP16 dfl arrays are read directly from DRP-AI output memory
+*                 and only the bins of the candidates are converted.
+* Arguments     : dfl = views of the dfl arrays (80, 40, 20 grids)
+*                 cls = views of the class arrays (80, 40, 20 grids)
+*                 candidates = list of the candidates with the decoded box
+* Return value  : -
+******************************************/
+void DFL::DFL_Sparse_Proc(const tensor_view* dfl, const tensor_view* cls, vector<dfl_candidate>& candidates)
+{
+    for (int32_t n = 0; n < NUM_INF_OUT_LAYER; n++)
     {
-        int32_t idx = 0;
+        class_in[n] = cls[n].fp32;
+    }
 
-        /* sigmoid_out_80 */
-        for (int i = 0; i < num_grids[0]; i++)
-        {
-            for (int j = 0; j < num_grids[0]; j++)
-            {
-                sigmoid_all_out[c * num_grid_points + idx] = sigmoid_out_80[c * num_grids[0] * num_grids[0] + i * num_grids[0] + j];
-                idx++;
-            }
-        }
-        /* sigmoid_out_40 */
-        for (int i = 0; i < num_grids[1]; i++)
+    /* Threshold processing on the class arrays */
+    run_chunks(&DFL::sparse_chunk);
+
+    /* DFL only for the candidates */
+    candidates.clear();
+    for (uint32_t chunk = 0; chunk < CPU_DFL_NUM_CHUNK; chunk++)
+    {
+        for (dfl_candidate& d : chunk_candidates[chunk])
         {
-            for (int j = 0; j < num_grids[1]; j++)
+            const tensor_view& v = dfl[d.scale];
+            if (InOutDataType::FLOAT16 == v.dtype)
             {
-                sigmoid_all_out[c * num_grid_points + idx] = sigmoid_out_40[c * num_grids[1] * num_grids[1] + i * num_grids[1] + j];
-                idx++;
+                decode_cell(reinterpret_cast<const uint16_t*>(v.data), v.shape[3], d.cell, d.box);
             }
-        }
-        /* sigmoid_out_20 */
-        for (int i = 0; i < num_grids[2]; i++)
-        {
-            for (int j = 0; j < num_grids[2]; j++)
+            else
             {
-                sigmoid_all_out[c * num_grid_points + idx] = sigmoid_out_20[c * num_grids[2] * num_grids[2] + i * num_grids[2] + j];
-                idx++;
+                decode_cell(v.fp32, v.shape[3], d.cell, d.box);
             }
+            candidates.push_back(d);
         }
     }
-    delete[] sigmoid_out_80;
-    delete[] sigmoid_out_40;
-    delete[] sigmoid_out_20;
 
-    /* Concat (84, 8400) */
-    /* dfl_all_out */
-    for (int i = 0; i < dfl_c; i++)
-    {
-        for (uint32_t j = 0; j < num_grid_points; j++)
-        {
-            output_buf[i * num_grid_points + j] = dfl_all_out[i * num_grid_points + j];
-        }
-    }
-    /* sigmoid_all_out */
-    for (int i = 0; i < NUM_CLASS; i++)
-    {
-        for (uint32_t j = 0; j < num_grid_points; j++)
-        {
-            output_buf[(dfl_c + i) * num_grid_points + j] = sigmoid_all_out[i * num_grid_points + j];
-        }
-    }
-    delete[] dfl_all_out;
-    delete[] sigmoid_all_out;
-    
     return;
 }
@@ -11,6 +11,7 @@
 * Includes
 ******************************************/
 #include "image_yolov8.h"
+#include "yuyv_convert.h"
 #include <opencv2/opencv.hpp>
 
 Image::Image()
@@ -112,6 +113,8 @@ uint8_t Image::init(uint32_t w, uint32_t h, uint32_t c,
         img_buffer[i] =(unsigned char*)mem+(i*out_size);
     }
 
+    init_text();
+
     return 0;
 }
 
@@ -150,9 +153,113 @@ uint8_t Image::init(uint32_t w, uint32_t h, uint32_t c,
         img_buffer[i] = new uint8_t[out_size];
     }
 
+    init_text();
+
+    return 0;
+}
+
+/*****************************************
+* Function Name : init_upscale
+* Description   : Function to initialize the fused YUYV to BGRA conversion with 2x upscale
+*                 and letterbox (convert_format_upscale).
+*                 The black border of all display buffers is painted here only once,
+*                 since convert_format_upscale writes the image area only.
+* Arguments     : resize_w = width of the upscaled image (twice the input width)
+*                 resize_h = height of the upscaled image (twice the input height)
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+uint8_t Image::init_upscale(uint32_t resize_w, uint32_t resize_h)
+{
+    int32_t i;
+
+    if ((resize_w != img_w * 2) || (resize_h != img_h * 2) || (resize_w > out_w) || (resize_h > out_h))
+    {
+        fprintf(stderr, "[ERROR] Unsupported upscale size: %dx%d -> %dx%d in %dx%d\n",
+            img_w, img_h, resize_w, resize_h, out_w, out_h);
+        return 1;
+    }
+
+    is_upscale = true;
+    draw_scale = 2.0f;
+    pad_top = (out_h - resize_h) / 2;
+    pad_left = (out_w - resize_w) / 2;
+
+    for (i = 0; i < WL_BUF_NUM; i++)
+    {
+        yuyv_buffer[i].resize(img_w * img_h * img_c);
+        cv::Mat bgra_image(out_h, out_w, CV_8UC4, img_buffer[i]);
+        bgra_image.setTo(cv::Scalar(0, 0, 0, 255));
+        text_area[i].clear();
+    }
+
+    init_text();
+
     return 0;
 }
 
+/*****************************************
+* Function Name : init_overlay
+* Description   : Function to initialize overlay_buffer for the overlay plane mode.
+*                 After this function, bounding boxes and texts are drawn into overlay_buffer
+*                 in the coordinate of the output image, and the camera image is not modified.
+* Arguments     : resize_w = width of the camera image in the output image
+*                 resize_h = height of the camera image in the output image
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+uint8_t Image::init_overlay(uint32_t resize_w, uint32_t resize_h)
+{
+    int32_t i;
+    uint32_t out_size = out_w * out_h * out_c;
+
+    if ((resize_w > out_w) || (resize_h > out_h))
+    {
+        fprintf(stderr, "[ERROR] Unsupported overlay size: %dx%d in %dx%d\n",
+            resize_w, resize_h, out_w, out_h);
+        return 1;
+    }
+
+    is_overlay = true;
+    draw_scale = (float)resize_w / img_w;
+    pad_top = (out_h - resize_h) / 2;
+    pad_left = (out_w - resize_w) / 2;
+
+    for (i = 0; i < WL_BUF_NUM; i++)
+    {
+        overlay_buffer[i] = new uint8_t[out_size];
+        /* Transparent */
+        memset(overlay_buffer[i], 0, out_size);
+        overlay_area[i].clear();
+    }
+
+    init_text();
+
+    return 0;
+}
+
+/*****************************************
+* Function Name : get_overlay_id
+* Description   : Function to get the index of overlay_buffer to be drawn and displayed
+* Arguments     : -
+* Return value  : overlay buffer index
+******************************************/
+uint8_t Image::get_overlay_id()
+{
+    return ol_id;
+}
+
+/*****************************************
+* Function Name : get_draw_buffer
+* Description   : Function to get the buffer where bounding boxes and texts are drawn
+* Arguments     : -
+* Return value  : overlay_buffer in the overlay plane mode, img_buffer otherwise
+******************************************/
+uint8_t* Image::get_draw_buffer()
+{
+    return is_overlay ? overlay_buffer[ol_id] : img_buffer[buf_id];
+}
+
 /*****************************************
 * Function Name : write_char
 * Description   : Display character in overlap buffer
@@ -197,9 +304,50 @@ void Image::write_char(char code,  uint32_t x,  uint32_t y, uint32_t color, uint
     return;
 }
 
+/*****************************************
+* Function Name : get_text_style
+* Description   : Get the atlas style of write_string_rgb (outlined FONT_HERSHEY_SIMPLEX).
+*                 The glyphs are rasterized at the first call for each scale.
+* Arguments     : scale = scale for letter size
+* Return Value  : index of the style in text_atlas
+******************************************/
+int32_t Image::get_text_style(float scale)
+{
+    return text_atlas.get_style(cv::FONT_HERSHEY_SIMPLEX, scale, CHAR_THICKNESS, CHAR_THICKNESS + 2);
+}
+
+/*****************************************
+* Function Name : get_box_text_style
+* Description   : Get the atlas style of the bounding box label (FONT_ITALIC without outline).
+*                 The glyphs are rasterized at the first call for each scale.
+* Arguments     : scale = scale for letter size
+* Return Value  : index of the style in text_atlas
+******************************************/
+int32_t Image::get_box_text_style(float scale)
+{
+    int32_t thickness = std::max(1, (int)std::lround(CHAR_THICKNESS_BOX * draw_scale));
+    return text_atlas.get_style(cv::FONT_ITALIC, scale, thickness, 0);
+}
+
+/*****************************************
+* Function Name : init_text
+* Description   : Rasterize the glyphs of the text styles used by the application,
+*                 so that no glyph is rendered with cv::putText while running.
+*                 Called at the end of the init functions since draw_scale may change.
+* Arguments     : -
+* Return Value  : -
+******************************************/
+void Image::init_text()
+{
+    get_text_style(CHAR_SCALE_LARGE);
+    get_text_style(CHAR_SCALE_SMALL);
+    get_box_text_style(CHAR_SCALE_FONT * draw_scale);
+}
+
 /*****************************************
 * Function Name : write_string_rgb
-* Description   : OpenCV putText() in RGB
+* Description   : Draw the outlined string in RGB with the glyph atlas,
+*                 in the same look as two OpenCV putText() calls.
 * Arguments     : str = string to be drawn
 *                 x = bottom left coordinate X of string to be drawn
 *                 y = bottom left coordinate Y of string to be drawn
@@ -208,19 +356,34 @@ void Image::write_char(char code,  uint32_t x,  uint32_t y, uint32_t color, uint
 * Return Value  : -
 ******************************************/
 void Image::write_string_rgb(std::string str, uint32_t align_type,  uint32_t x, uint32_t y, float scale, uint32_t color)
+{
+    write_string_rgb("", str.c_str(), align_type, x, y, scale, color);
+}
+
+/*****************************************
+* Function Name : write_string_rgb
+* Description   : Draw the outlined string in RGB with the glyph atlas.
+*                 The label is copied from a sprite cached for each color,
+*                 and only the value is drawn glyph by glyph.
+* Arguments     : label = fixed part of the string, e.g. "Total AI Time : "
+*                 value = changing part of the string drawn after the label
+*                 x = bottom left coordinate X of string to be drawn
+*                 y = bottom left coordinate Y of string to be drawn
+*                 scale = scale for letter size
+*                 color = letter color must be in RGB, e.g. white = 0xFFFFFF
+* Return Value  : -
+******************************************/
+void Image::write_string_rgb(const char* label, const char* value, uint32_t align_type,  uint32_t x, uint32_t y, float scale, uint32_t color)
 {
     uint8_t thickness = CHAR_THICKNESS;
-    /*Extract RGB information*/
-    uint8_t r = (color >> 16) & 0x0000FF;
-    uint8_t g = (color >>  8) & 0x0000FF;
-    uint8_t b = color & 0x0000FF;
+    int32_t style = get_text_style(scale);
+    int32_t width = text_atlas.get_width(style, label, value);
+    int32_t height = text_atlas.get_height(style);
+    int32_t baseline = text_atlas.get_descent(style);
     int ptx = 0;
     int pty = 0;
-    /*OpenCV image data is in BGRA */
-    cv::Mat bgra_image(out_h, out_w, CV_8UC4, img_buffer[buf_id]);
+    uint8_t* bgra = get_draw_buffer();
 
-    int baseline = 0;
-    cv::Size size = cv::getTextSize(str.c_str(), cv::FONT_HERSHEY_SIMPLEX, scale, thickness + 2, &baseline);
     if (align_type == 1)
     {
         ptx = x;
@@ -228,27 +391,42 @@ void Image::write_string_rgb(std::string str, uint32_t align_type,  uint32_t x,
     }
     else if (align_type == 2)
     {
-        ptx = out_w - (size.width + x);
+        ptx = out_w - (width + x);
         pty = y;
     }
-    /*Color must be in BGR order*/
-    cv::putText(bgra_image, str.c_str(), cv::Point(ptx, pty), cv::FONT_HERSHEY_SIMPLEX, scale, cv::Scalar(0x00, 0x00, 0x00, 0xFF), thickness + 2);
-    cv::putText(bgra_image, str.c_str(), cv::Point(ptx, pty), cv::FONT_HERSHEY_SIMPLEX, scale, cv::Scalar(b, g, r, 0xFF), thickness);
+    add_text_area(ptx - thickness - 2, pty - height - thickness - 2,
+        ptx + width + thickness + 2, pty + baseline + thickness + 2);
+    if ('\0' != label[0])
+    {
+        ptx += text_atlas.draw_sprite(bgra, out_w, out_h, style, label, ptx, pty, color);
+    }
+    text_atlas.draw_text(bgra, out_w, out_h, style, value, ptx, pty, color);
 }
 
 /*****************************************
-* Function Name : write_string_rgb
-* Description   : OpenCV putText() in RGB
-* Arguments     : str = string to be drawn
-*                 x = bottom left coordinate X of string to be drawn
-*                 y = bottom left coordinate Y of string to be drawn
+* Function Name : write_string_rgb_boundingbox
+* Description   : Draw the bounding box and its label in RGB.
+*                 The label is copied from a sprite cached for each class
+*                 and only the value is drawn glyph by glyph.
+* Arguments     : label = class name
+*                 value = probability string drawn after the label
+*                 x_min = left of the bounding box
+*                 y_min = top of the bounding box
+*                 x_max = right of the bounding box
+*                 y_max = bottom of the bounding box
 *                 scale = scale for letter size
-*                 color = letter color must be in RGB, e.g. white = 0xFFFFFF
+*                 color = box color must be in RGB, e.g. white = 0xFFFFFF
 * Return Value  : -
 ******************************************/
-void Image::write_string_rgb_boundingbox(std::string str, uint32_t align_type,  uint32_t x_min, uint32_t y_min, uint32_t x_max, uint32_t y_max,float scale, uint32_t color)
+void Image::write_string_rgb_boundingbox(const char* label, const char* value, uint32_t align_type,  uint32_t x_min, uint32_t y_min, uint32_t x_max, uint32_t y_max,float scale, uint32_t color)
 {
-    uint8_t thickness = CHAR_THICKNESS_BOX;
+    int32_t line_size = std::max(1, (int)std::lround(BOX_LINE_SIZE * draw_scale));
+    int32_t height_offset = std::lround(BOX_HEIGHT_OFFSET * draw_scale);
+    int32_t text_height_offset = std::lround(BOX_TEXT_HEIGHT_OFFSET * draw_scale);
+    int32_t style = get_box_text_style(scale);
+    /* Draw in the coordinate of the output image when the fused upscale or the overlay is used */
+    uint32_t canvas_w = (is_upscale || is_overlay) ? out_w : img_w;
+    uint32_t canvas_h = (is_upscale || is_overlay) ? out_h : img_h;
     /*Extract RGB information*/
     uint8_t r = (color >> 16) & 0x0000FF;
     uint8_t g = (color >>  8) & 0x0000FF;
@@ -257,12 +435,12 @@ void Image::write_string_rgb_boundingbox(std::string str, uint32_t align_type,
     int ptx = 0;
     int pty = 0;
     /*OpenCV image data is in BGRA */
-    cv::Mat bgra_image(img_h, img_w, CV_8UC4, img_buffer[buf_id]);
+    cv::Mat bgra_image(canvas_h, canvas_w, CV_8UC4, get_draw_buffer());
 
-    int baseline = 0;
-    cv::rectangle(bgra_image, cv::Point(x_min,y_min), cv::Point(x_max,y_max), cv::Scalar(b, g, r, 0xFF), BOX_LINE_SIZE);
+    cv::rectangle(bgra_image, cv::Point(x_min,y_min), cv::Point(x_max,y_max), cv::Scalar(b, g, r, 0xFF), line_size);
     
-    cv::Size size = cv::getTextSize(str.c_str(), cv::FONT_ITALIC, scale, thickness + 2, &baseline);
+    /* The label background has the width of cv::getTextSize with thickness + 2. */
+    int32_t width = text_atlas.get_width(style, label, value) + 2;
     if (align_type == 1)
     {
         ptx = x_min;
@@ -270,12 +448,15 @@ void Image::write_string_rgb_boundingbox(std::string str, uint32_t align_type,
     }
     else if (align_type == 2)
     {
-        ptx = img_w - (size.width + x_min);
+        ptx = canvas_w - (width + x_min);
         pty = y_min;
     }
-    cv::rectangle(bgra_image, cv::Point(ptx-BOX_LINE_SIZE+1,pty-BOX_HEIGHT_OFFSET), cv::Point(ptx+size.width,pty), cv::Scalar(b, g, r, 0xFF), cv::FILLED);
-    /*Color must be in BGR order*/
-    cv::putText(bgra_image, str.c_str(), cv::Point(ptx, pty-BOX_TEXT_HEIGHT_OFFSET), cv::FONT_ITALIC, scale, cv::Scalar(0x00, 0x00, 0x00, 0xFF), thickness);
+    /* The label and the box may stick out of the image into the letterbox border. */
+    add_text_area(std::min(ptx - line_size + 1, (int)x_min) - line_size, std::min(pty - height_offset, (int)y_min) - line_size,
+        std::max(ptx + width, (int)x_max) + line_size, (int)y_max + line_size);
+    cv::rectangle(bgra_image, cv::Point(ptx-line_size+1,pty-height_offset), cv::Point(ptx+width,pty), cv::Scalar(b, g, r, 0xFF), cv::FILLED);
+    ptx += text_atlas.draw_sprite(get_draw_buffer(), canvas_w, canvas_h, style, label, ptx, pty - text_height_offset, BLACK_DATA);
+    text_atlas.draw_text(get_draw_buffer(), canvas_w, canvas_h, style, value, ptx, pty - text_height_offset, BLACK_DATA);
 }
 
 /*****************************************
@@ -411,10 +592,11 @@ void Image::draw_line(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t c
 *                 y = Y coordinate of the center of rectangle
 *                 w = width of the rectangle
 *                 h = height of the rectangle
-*                 str = string to label the rectangle
+*                 label = class name to label the rectangle
+*                 value = probability string drawn after the label
 * Return Value  : -
 ******************************************/
-void Image::draw_rect(int32_t x, int32_t y, int32_t w, int32_t h, const char * str,uint32_t color)
+void Image::draw_rect(int32_t x, int32_t y, int32_t w, int32_t h, const char* label, const char* value, uint32_t color)
 {
     int32_t x_min = x - round(w / 2.);
     int32_t y_min = y - round(h / 2.);
@@ -426,8 +608,14 @@ void Image::draw_rect(int32_t x, int32_t y, int32_t w, int32_t h, const char * s
     y_min = y_min < 1 ? 1 : y_min;
     y_max = (((int32_t)img_h - 2) < y_max) ? ((int32_t)img_h - 2) : y_max;
 
+    /* Map to the coordinate of the output image (identity unless init_upscale or init_overlay is called) */
+    x_min = (int32_t)(x_min * draw_scale) + pad_left;
+    y_min = (int32_t)(y_min * draw_scale) + pad_top;
+    x_max = (int32_t)((x_max + 1) * draw_scale) - 1 + pad_left;
+    y_max = (int32_t)((y_max + 1) * draw_scale) - 1 + pad_top;
+
     /* Draw the bounding box and class and probability*/
-    write_string_rgb_boundingbox(str,1,x_min, y_min,x_max,y_max,CHAR_SCALE_FONT,color);
+    write_string_rgb_boundingbox(label, value, 1, x_min, y_min, x_max, y_max, CHAR_SCALE_FONT * draw_scale, color);
 
     return;
 }
@@ -446,48 +634,94 @@ void Image::convert_format()
     start = chrono::system_clock::now();
 #endif // DEBUG_TIME_FLG
 
-    uint8_t* pd = img_buffer[buf_id];
-    uint8_t buffer[img_w * img_h * out_c];
-    int pix_count = 0;
-    for (uint32_t i = 0; i < img_h * img_w / 2; i++)
+    if (NULL != camera_buffer[buf_id])
     {
-        int y0 = (int)pd[0] - 16;
-        int u0 = (int)pd[1] - 128;
-        int y1 = (int)pd[2] - 16;
-        int v0 = (int)pd[3] - 128;
+        yuyv_to_bgra(camera_buffer[buf_id], img_buffer[buf_id], (int64_t)img_w * img_h);
+    }
+    else
+    {
+        /* img_buffer holds YUYV copied by camera_to_image and has the size of BGRA image,
+         * so the conversion is done in place from the last pixel. */
+        yuyv_to_bgra(img_buffer[buf_id], img_buffer[buf_id], (int64_t)img_w * img_h);
+    }
 
-        pd += 4;
-        buffer[pix_count++] = Clip((298 * y0 + 516 * u0 + 128) >> 8); // blue
-        buffer[pix_count++] = Clip((298 * y0 - 100 * u0 - 208 * v0 + 128) >> 8); // green
-        buffer[pix_count++] = Clip((298 * y0 + 409 * v0 + 128) >> 8); // red
-        buffer[pix_count++] = 255;
+#ifdef DEBUG_TIME_FLG
+    end = chrono::system_clock::now();
+    double time = static_cast<double>(chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0);
+    printf("Convert YUYV To BGRA Time : %lf[ms]\n", time);
+#endif // DEBUG_TIME_FLG
+}
 
-        buffer[pix_count++] = Clip((298 * y1 + 516 * u0 + 128) >> 8); // blue
-        buffer[pix_count++] = Clip((298 * y1 - 100 * u0 - 208 * v0 + 128) >> 8); // green
-        buffer[pix_count++] = Clip((298 * y1 + 409 * v0 + 128) >> 8); // red
-        buffer[pix_count++] = 255;
+/*****************************************
+* Function Name : convert_format_upscale
+* Description   : Convert YUYV image to BGRA format, upscale it by 2 and place it
+*                 at the center of the output image in one pass.
+*                 Replaces convert_format and convert_size after init_upscale.
+*                 Only the text drawn on the letterbox border in the previous use of
+*                 the buffer is cleared; the rest of the border is kept as painted at init.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void Image::convert_format_upscale()
+{
+#ifdef DEBUG_TIME_FLG
+    using namespace std;
+    chrono::system_clock::time_point start, end;
+    start = chrono::system_clock::now();
+#endif // DEBUG_TIME_FLG
+
+    cv::Mat bgra_image(out_h, out_w, CV_8UC4, img_buffer[buf_id]);
+    for (const draw_area_t& area : text_area[buf_id])
+    {
+        bgra_image(cv::Rect(area.x, area.y, area.w, area.h)).setTo(cv::Scalar(0, 0, 0, 255));
     }
-    memcpy(img_buffer[buf_id], &buffer, img_w * img_h * out_c);
+    text_area[buf_id].clear();
+
+    const uint8_t* src = (NULL != camera_buffer[buf_id]) ? camera_buffer[buf_id] : yuyv_buffer[buf_id].data();
+    yuyv_to_bgra_upscale2(src, img_buffer[buf_id] + (pad_top * out_w + pad_left) * out_c,
+        img_w, img_h, out_w * out_c);
 
 #ifdef DEBUG_TIME_FLG
     end = chrono::system_clock::now();
     double time = static_cast<double>(chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0);
-    printf("Convert YUYV To BGRA Time : %lf[ms]\n", time);
+    printf("Convert and Upscale Time  : %lf[ms]\n", time);
 #endif // DEBUG_TIME_FLG
 }
 
-uint8_t Image::Clip(int value)
+/*****************************************
+* Function Name : add_text_area
+* Description   : Record the area drawn by text, which is cleared by reset_overlay_img
+*                 (overlay plane mode) or convert_format_upscale before the buffer is used again.
+* Arguments     : x_min = left of the area
+*                 y_min = top of the area
+*                 x_max = right of the area
+*                 y_max = bottom of the area
+* Return value  : -
+******************************************/
+void Image::add_text_area(int32_t x_min, int32_t y_min, int32_t x_max, int32_t y_max)
 {
-    //unsigned char ret = (uint8_t)std::round(value);
-    if (value > 255)
+    draw_area_t area;
+
+    x_min = std::max(x_min, 0);
+    y_min = std::max(y_min, 0);
+    x_max = std::min(x_max, (int32_t)out_w - 1);
+    y_max = std::min(y_max, (int32_t)out_h - 1);
+    if ((x_min > x_max) || (y_min > y_max))
     {
-        value = 255;
+        return;
     }
-    if (value < 0)
+    area.x = x_min;
+    area.y = y_min;
+    area.w = x_max - x_min + 1;
+    area.h = y_max - y_min + 1;
+    if (is_overlay)
     {
-        value = 0;
+        overlay_area[ol_id].push_back(area);
+    }
+    else if (is_upscale)
+    {
+        text_area[buf_id].push_back(area);
     }
-    return value;
 }
 
 /*****************************************
@@ -555,16 +789,39 @@ void Image::convert_size(int in_w, int resize_w, int in_h, int resize_h, bool is
 /*****************************************
 * Function Name : camera_to_image
 * Description   : Function to copy the external image buffer data to img_buffer
-*                 This is only place where the buf_id is updated.
-* Arguments     : buffer = buffer to copy the image data
+*                 The slot is given by the frame ring, so the Capture Thread does not
+*                 change buf_id used by the Image Thread.
+* Arguments     : id = index of img_buffer to copy the image data
+*                 buffer = buffer to copy the image data
 *                 size = size of buffer
 * Return value  : none
 ******************************************/
-void Image::camera_to_image(const uint8_t* buffer, int32_t size)
+void Image::camera_to_image(uint8_t id, const uint8_t* buffer, int32_t size)
 {
-    /* Update buffer id */
-    buf_id = (buf_id + 1) % WL_BUF_NUM;
-    memcpy(img_buffer[buf_id], buffer, sizeof(uint8_t)*size);
+    camera_buffer[id] = NULL;
+    if (is_upscale)
+    {
+        /* img_buffer keeps the letterbox border, so YUYV is staged in yuyv_buffer. */
+        memcpy(yuyv_buffer[id].data(), buffer, sizeof(uint8_t)*size);
+    }
+    else
+    {
+        memcpy(img_buffer[id], buffer, sizeof(uint8_t)*size);
+    }
+}
+
+/*****************************************
+* Function Name : set_camera_buffer
+* Description   : Let convert_format and convert_format_upscale read the external YUYV buffer
+*                 directly instead of the copy made by camera_to_image.
+*                 The buffer must be kept until the conversion of the slot finishes.
+* Arguments     : id = index of img_buffer to be converted from the buffer
+*                 buffer = YUYV buffer of the camera image
+* Return value  : none
+******************************************/
+void Image::set_camera_buffer(uint8_t id, const uint8_t* buffer)
+{
+    camera_buffer[id] = buffer;
 }
 
 /*****************************************
@@ -593,6 +850,17 @@ void Image::set(int32_t a, uint8_t val)
     return;
 }
 
+/*****************************************
+* Function Name : set_buf_id
+* Description   : Select the buffer to be converted and drawn.
+* Arguments     : id = index of img_buffer
+* Return Value  : -
+******************************************/
+void Image::set_buf_id(uint8_t id)
+{
+    buf_id = id;
+}
+
 /*****************************************
 * Function Name : get_buf_id
 * Description   : Get the value of the buf_id.
@@ -606,9 +874,10 @@ uint8_t Image::get_buf_id(void)
 
 /*****************************************
 * Function Name : reset_overlay_img
-* Description   : -
+* Description   : Switch to the next overlay_buffer and clear it.
+*                 Only the areas drawn in the previous use of the buffer are cleared.
 * Arguments     : -
-* Return Value  : -
+* Return value  : -
 ******************************************/
 void Image::reset_overlay_img()
 {
@@ -618,10 +887,16 @@ void Image::reset_overlay_img()
     start = chrono::system_clock::now();
 #endif // DEBUG_TIME_FLG
 
-    cv::Mat src_image = cv::Mat::zeros(out_h, out_w, CV_8UC4);
-    uint8_t* dst = overlay_buffer[buf_id];
-    uint8_t* src = src_image.data;
-    memcpy(dst, src, out_w * out_h * out_c);
+    ol_id = (ol_id + 1) % WL_BUF_NUM;
+    uint8_t* dst = overlay_buffer[ol_id];
+    for (const draw_area_t& area : overlay_area[ol_id])
+    {
+        for (int32_t y = area.y; y < area.y + area.h; y++)
+        {
+            memset(dst + (y * out_w + area.x) * out_c, 0, area.w * out_c);
+        }
+    }
+    overlay_area[ol_id].clear();
 
 #ifdef DEBUG_TIME_FLG
     end = chrono::system_clock::now();
@@ -12,6 +12,16 @@
 
 #include "define.h"
 #include "ascii.h"
+#include "text_atlas.h"
+
+/* Area of the display buffer drawn by text */
+typedef struct draw_area
+{
+    int32_t x;
+    int32_t y;
+    int32_t w;
+    int32_t h;
+} draw_area_t;
 
 class Image
 {
@@ -22,8 +32,10 @@ class Image
         uint8_t* img_buffer[WL_BUF_NUM];
         uint8_t* overlay_buffer[WL_BUF_NUM];
         uint8_t get_buf_id();
+        void set_buf_id(uint8_t id);
         void write_string_rgb(std::string str, uint32_t align_type, uint32_t x, uint32_t y, float size, uint32_t color);
-        void write_string_rgb_boundingbox(std::string str, uint32_t align_type,  uint32_t x_min, uint32_t y_min, uint32_t x_max, uint32_t y_max,float scale, uint32_t color);
+        void write_string_rgb(const char* label, const char* value, uint32_t align_type, uint32_t x, uint32_t y, float size, uint32_t color);
+        void write_string_rgb_boundingbox(const char* label, const char* value, uint32_t align_type,  uint32_t x_min, uint32_t y_min, uint32_t x_max, uint32_t y_max,float scale, uint32_t color);
 
         uint32_t get_H();
         uint32_t get_W();
@@ -35,11 +47,16 @@ class Image
 
         uint8_t init(uint32_t w, uint32_t h, uint32_t c, uint32_t ow, uint32_t oh, uint32_t oc, void *mem);
         uint8_t init(uint32_t w, uint32_t h, uint32_t c, uint32_t ow, uint32_t oh, uint32_t oc);
-        void draw_rect(int32_t x, int32_t y, int32_t w, int32_t h, const char* str,uint32_t color);
+        uint8_t init_upscale(uint32_t resize_w, uint32_t resize_h);
+        uint8_t init_overlay(uint32_t resize_w, uint32_t resize_h);
+        uint8_t get_overlay_id();
+        void draw_rect(int32_t x, int32_t y, int32_t w, int32_t h, const char* label, const char* value, uint32_t color);
         void reset_overlay_img();
         void convert_format();
+        void convert_format_upscale();
         void convert_size(int in_w, int resize_w, int in_h, int resize_h, bool is_padding);
-        void camera_to_image(const uint8_t* buffer, int32_t size);
+        void camera_to_image(uint8_t id, const uint8_t* buffer, int32_t size);
+        void set_camera_buffer(uint8_t id, const uint8_t* buffer);
     private:
         uint8_t buf_id = 0;
 
@@ -52,6 +69,28 @@ class Image
         uint32_t out_w;
         uint32_t out_c;
 
+        /* Fused YUYV to BGRA conversion with 2x upscale and letterbox */
+        bool is_upscale             = false;
+        std::vector<uint8_t> yuyv_buffer[WL_BUF_NUM];
+        /* YUYV capture buffer converted directly, NULL if copied by camera_to_image */
+        const uint8_t* camera_buffer[WL_BUF_NUM] = {};
+        std::vector<draw_area_t> text_area[WL_BUF_NUM];
+        /* Overlay plane mode */
+        bool is_overlay             = false;
+        uint8_t ol_id               = 0;
+        std::vector<draw_area_t> overlay_area[WL_BUF_NUM];
+        /* Mapping from the camera image to the output image */
+        float draw_scale            = 1.0f;
+        uint32_t pad_top            = 0;
+        uint32_t pad_left           = 0;
+        uint8_t* get_draw_buffer();
+        void add_text_area(int32_t x_min, int32_t y_min, int32_t x_max, int32_t y_max);
+        /* Pre-rasterized glyphs and label sprites */
+        TextAtlas text_atlas;
+        int32_t get_text_style(float scale);
+        int32_t get_box_text_style(float scale);
+        void init_text();
+
         uint32_t front_color        = BLACK_DATA;
         uint32_t back_color         = WHITE_DATA;
         uint8_t font_w              = FONTDATA_WIDTH;
@@ -60,7 +99,6 @@ class Image
         void draw_line(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
         void write_char(char code,  uint32_t x,  uint32_t y, uint32_t color, uint32_t backcolor);
         void write_string(const char * pcode, uint32_t x, uint32_t y, uint32_t color, uint32_t backcolor);
-        uint8_t Clip(int value);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,163 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : nms.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for Ultralytics Detection YOLOv8 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "nms.h"
+#include <algorithm>
+
+using namespace std;
+
+NMS::NMS()
+{
+    bin_w = 0;
+    bin_h = 0;
+}
+
+NMS::~NMS()
+{
+
+}
+
+/*****************************************
+* Function Name : bin_range
+* Description   : Get the spatial bins covered by the box.
+* Arguments     : b = box (center x, center y, width, height)
+*                 x0, y0 = first bin
+*                 x1, y1 = last bin
+* Return value  : -
+******************************************/
+void NMS::bin_range(const Box& b, int32_t* x0, int32_t* y0, int32_t* x1, int32_t* y1)
+{
+    *x0 = (int32_t)floorf((b.x - b.w / 2) / NMS_BIN_SIZE);
+    *y0 = (int32_t)floorf((b.y - b.h / 2) / NMS_BIN_SIZE);
+    *x1 = (int32_t)floorf((b.x + b.w / 2) / NMS_BIN_SIZE);
+    *y1 = (int32_t)floorf((b.y + b.h / 2) / NMS_BIN_SIZE);
+    /* Boxes out of the image are put in the edge bins */
+    *x0 = min(max(*x0, 0), bin_w - 1);
+    *y0 = min(max(*y0, 0), bin_h - 1);
+    *x1 = min(max(*x1, 0), bin_w - 1);
+    *y1 = min(max(*y1, 0), bin_h - 1);
+}
+
+/*****************************************
+* Function Name : is_suppressed
+* Description   : Check if the box b is suppressed by the kept box a.
+*                 Same condition as filter_boxes_nms: IoU over th_nms,
+*                 or one box contains the other.
+* Arguments     : a = kept box
+*                 b = box to be checked
+*                 th_nms = threshold of IoU
+* Return value  : true if b is suppressed
+******************************************/
+bool NMS::is_suppressed(const Box& a, const Box& b, float th_nms)
+{
+    float w = min(a.x + a.w / 2, b.x + b.w / 2) - max(a.x - a.w / 2, b.x - b.w / 2);
+    float h = min(a.y + a.h / 2, b.y + b.h / 2) - max(a.y - a.h / 2, b.y - b.h / 2);
+    float area_a = a.w * a.h;
+    float area_b = b.w * b.h;
+    float inter = 0;
+    float uni = 0;
+
+    if ((w <= 0) || (h <= 0))
+    {
+        return false;
+    }
+    inter = w * h;
+    uni = area_a + area_b - inter;
+    return ((inter > th_nms * uni) || (inter >= area_a - 1) || (inter >= area_b - 1));
+}
+
+/*****************************************
+* Function Name : NMS_Proc
+* Description   : Class-aware Non-Maximum Suppression.
+*                 1. Keeps the NMS_TOP_K boxes with the highest probability.
+*                 2. Sorts the boxes once by class and probability.
+*                 3. Checks each box only against the kept boxes of the same class
+*                    in the spatial bins it covers.
+*                 det is replaced with the kept boxes in the order of probability.
+* Arguments     : det = detected boxes
+*                 th_nms = threshold of IoU
+*                 width, height = size of the coordinate space of the boxes
+* Return value  : -
+******************************************/
+void NMS::NMS_Proc(vector<detection>& det, float th_nms, int32_t width, int32_t height)
+{
+    int32_t x0 = 0;
+    int32_t y0 = 0;
+    int32_t x1 = 0;
+    int32_t y1 = 0;
+
+    /* Pre-NMS top-K */
+    if (det.size() > NMS_TOP_K)
+    {
+        nth_element(det.begin(), det.begin() + NMS_TOP_K, det.end(),
+            [](const detection& a, const detection& b) { return a.prob > b.prob; });
+        det.resize(NMS_TOP_K);
+    }
+    sort(det.begin(), det.end(), [](const detection& a, const detection& b)
+        { return (a.c != b.c) ? (a.c < b.c) : (a.prob > b.prob); });
+
+    bin_w = max((width + NMS_BIN_SIZE - 1) / NMS_BIN_SIZE, 1);
+    bin_h = max((height + NMS_BIN_SIZE - 1) / NMS_BIN_SIZE, 1);
+    bins.resize(bin_w * bin_h);
+    kept.clear();
+
+    for (size_t i = 0; i < det.size(); i++)
+    {
+        /* Start of a new class */
+        if ((0 == i) || (det[i].c != det[i - 1].c))
+        {
+            for (uint32_t n : used_bins)
+            {
+                bins[n].clear();
+            }
+            used_bins.clear();
+        }
+
+        bool suppressed = false;
+        bin_range(det[i].bbox, &x0, &y0, &x1, &y1);
+        for (int32_t y = y0; (y <= y1) && !suppressed; y++)
+        {
+            for (int32_t x = x0; (x <= x1) && !suppressed; x++)
+            {
+                for (uint32_t k : bins[y * bin_w + x])
+                {
+                    if (is_suppressed(kept[k].bbox, det[i].bbox, th_nms))
+                    {
+                        suppressed = true;
+                        break;
+                    }
+                }
+            }
+        }
+        if (suppressed)
+        {
+            continue;
+        }
+
+        for (int32_t y = y0; y <= y1; y++)
+        {
+            for (int32_t x = x0; x <= x1; x++)
+            {
+                if (bins[y * bin_w + x].empty())
+                {
+                    used_bins.push_back(y * bin_w + x);
+                }
+                bins[y * bin_w + x].push_back(kept.size());
+            }
+        }
+        kept.push_back(det[i]);
+    }
+
+    sort(kept.begin(), kept.end(), [](const detection& a, const detection& b) { return a.prob > b.prob; });
+    det.swap(kept);
+    return;
+}
@@ -0,0 +1,258 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : post_proc.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for Ultralytics Detection YOLOv8 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "post_proc.h"
+#include "class_argmax.h"
+#include "latency_hist.h"
+
+using namespace std;
+
+PostProc::PostProc()
+{
+#if (1) != CPU_DFL_SPARSE_DECODE
+    drpai_output_buf.resize(num_inf_out);
+    max_score.resize(num_grid_points);
+    max_class.resize(num_grid_points);
+#endif
+}
+
+PostProc::~PostProc()
+{
+
+}
+
+/*****************************************
+* Function Name : init
+* Description   : Start the worker threads of CPU DFL processing.
+* Arguments     : -
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t PostProc::init()
+{
+    return dfl.init();
+}
+
+/*****************************************
+* Function Name : set_outputs
+* Description   : Bind DRP-AI outputs to the tensor views.
+*                 Each output is bound to the view of its layer, identified by
+*                 the number of elements. FP32 outputs are read in place by the
+*                 post-processing. FP16 outputs are converted only when needed.
+* Arguments     : outputs = tuples of { data type, address of output data, number of elements }
+*                 num_output = number of outputs
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t PostProc::set_outputs(const std::tuple<InOutDataType, void*, int64_t>* outputs, int32_t num_output)
+{
+    int8_t ret = 0;
+    int32_t i = 0;
+    int32_t n = 0;
+    int32_t num_bound = 0;
+    int64_t output_size;
+    int32_t grid = 0;
+    /* FP16 dfl arrays are read directly by DFL_Sparse_Proc */
+    bool dfl_need_fp32 = (1 != CPU_DFL_SPARSE_DECODE);
+
+    for (i = 0; i < num_output; i++)
+    {
+        output_size = std::get<2>(outputs[i]);
+
+        for (n = 0; n < NUM_INF_OUT_LAYER; n++)
+        {
+            grid = num_grids[n];
+            if (output_size == (REG_MAX * 4) * grid * grid)
+            {
+                ret = bind_tensor_view(output_dfl[n], outputs[i], REG_MAX * 4, grid, grid, dfl_need_fp32);
+                num_bound++;
+                break;
+            }
+            if (output_size == NUM_CLASS * grid * grid)
+            {
+                ret = bind_tensor_view(output_class[n], outputs[i], NUM_CLASS, grid, grid, true);
+                num_bound++;
+                break;
+            }
+        }
+        if (0 != ret)
+        {
+            break;
+        }
+    }
+    if ((0 == ret) && (NUM_INF_OUT_LAYER * 2 != num_bound))
+    {
+        fprintf(stderr, "[ERROR] Output number mismatch : %d (expected %d).\n", num_bound, NUM_INF_OUT_LAYER * 2);
+        ret = -1;
+    }
+    return ret;
+}
+
+/*****************************************
+* Function Name : get_view
+* Description   : Get the tensor view bound to the output.
+* Arguments     : size = number of elements of the output
+* Return value  : tensor view
+*                 NULL if the output is not used
+******************************************/
+const tensor_view* PostProc::get_view(int64_t size)
+{
+    for (int32_t n = 0; n < NUM_INF_OUT_LAYER; n++)
+    {
+        if (size == output_dfl[n].size)
+        {
+            return &output_dfl[n];
+        }
+        if (size == output_class[n].size)
+        {
+            return &output_class[n];
+        }
+    }
+    return NULL;
+}
+
+/*****************************************
+* Function Name : get_argmax_time
+* Description   : Get the time of the class argmax in the last decode.
+*                 With CPU_DFL_SPARSE_DECODE, the argmax is done in dfl_proc and this returns 0.
+* Arguments     : -
+* Return value  : time [ns]
+******************************************/
+uint64_t PostProc::get_argmax_time()
+{
+    return argmax_time;
+}
+
+/*****************************************
+* Function Name : dfl_proc
+* Description   : DFL process of the bound outputs.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void PostProc::dfl_proc()
+{
+#if (1) == CPU_DFL_SPARSE_DECODE
+    dfl.DFL_Sparse_Proc(output_dfl, output_class, dfl_candidates);
+#else
+    dfl.DFL_Proc(output_dfl, output_class, drpai_output_buf.data());
+#endif
+}
+
+#if (1) == CPU_DFL_SPARSE_DECODE
+/*****************************************
+* Function Name : decode
+* Description   : Process CPU post-processing for Yolov8 on the candidates of DFL_Sparse_Proc
+* Arguments     : det_buff = detections over the threshold in model input size
+* Return value  : -
+******************************************/
+void PostProc::decode(vector<detection>& det_buff)
+{
+    float probability = 0;
+    detection d;
+
+    det_buff.clear();
+    for (dfl_candidate& cand : dfl_candidates)
+    {
+        /* The candidates are already over the threshold in logit space. */
+        probability = dfl.sigmoid(cand.score);
+
+        Box bb = {cand.box[0], cand.box[1], cand.box[2], cand.box[3]};
+        d = {bb, cand.c, probability};
+        det_buff.push_back(d);
+    }
+    return;
+}
+#else
+/*****************************************
+* Function Name : decode
+* Description   : Process CPU post-processing for Yolov8
+* Arguments     : det_buff = detections over the threshold in model input size
+* Return value  : -
+******************************************/
+void PostProc::decode(vector<detection>& det_buff)
+{
+    const float* floatarr = drpai_output_buf.data();
+    uint32_t i = 0;
+    float probability = 0;
+    float center_x = 0;
+    float center_y = 0;
+    float box_w = 0;
+    float box_h = 0;
+    int32_t pred_class = -1;
+    detection d;
+
+#if (2) <= CPU_DFL_SIGMOID_SKIP
+    /* Threshold for non-sigmoid value */
+    float th_prob = 0;              
+    if (TH_PROB <= 0) { th_prob = -FLT_MAX; }
+    else if (TH_PROB >= 1) { th_prob = FLT_MAX; }
+    else { th_prob = logf( TH_PROB / (1.0f-TH_PROB) ); }
+#else
+    /* Threshold for sigmoid value */
+    float th_prob = TH_PROB;
+#endif
+
+    /* Class rows 4-(4 + NUM_CLASS - 1) of floatarr (4 + NUM_CLASS, num_grid_points) */
+    uint64_t argmax_start = LatencyHist::now();
+    class_argmax(floatarr + 4 * num_grid_points, num_grid_points, NUM_CLASS, num_grid_points, max_score.data(), max_class.data());
+    argmax_time = LatencyHist::now() - argmax_start;
+
+    det_buff.clear();
+    for (i = 0; i < num_grid_points; i++)
+    {
+        /* Store the result into the list if the probability is more than the threshold */
+        probability = max_score[i];
+        pred_class = max_class[i];
+#if (1) == CPU_DFL_SIGMOID_SKIP
+        probability = dfl.sigmoid(probability);
+#endif
+        if (probability > th_prob)
+        {
+            /* Adjustment for size */
+            /* correct_yolo/region_boxes */
+            center_x = floatarr[0 * num_grid_points + i];
+            center_y = floatarr[1 * num_grid_points + i];
+            box_w = floatarr[2 * num_grid_points + i];
+            box_h = floatarr[3 * num_grid_points + i];
+
+#if (2) <= CPU_DFL_SIGMOID_SKIP
+            probability = dfl.sigmoid(probability);
+#endif
+            Box bb = {center_x, center_y, box_w, box_h};
+            d = {bb, pred_class, probability};
+            det_buff.push_back(d);
+        }
+    }
+    return;
+}
+#endif
+
+/*****************************************
+* Function Name : nms_proc
+* Description   : Apply NMS to the detections and scale them to DRP-AI input size.
+* Arguments     : det_buff = detections over the threshold in model input size
+* Return value  : -
+******************************************/
+void PostProc::nms_proc(vector<detection>& det_buff)
+{
+    /* Non-Maximum Supression filter */
+    nms.NMS_Proc(det_buff, TH_NMS, MODEL_IN_W, MODEL_IN_H);
+
+    for (detection& d : det_buff)
+    {
+        d.bbox.x = d.bbox.x * float(DRPAI_IN_WIDTH) / float(MODEL_IN_W);
+        d.bbox.y = d.bbox.y * float(DRPAI_IN_HEIGHT) / float(MODEL_IN_H);
+        d.bbox.w = d.bbox.w * float(DRPAI_IN_WIDTH) / float(MODEL_IN_W);
+        d.bbox.h = d.bbox.h * float(DRPAI_IN_HEIGHT) / float(MODEL_IN_H);
+    }
+    return;
+}
@@ -0,0 +1,357 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : text_atlas.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for Ultralytics Detection YOLOv8 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "text_atlas.h"
+#include <opencv2/opencv.hpp>
+
+/* Pixel value of the outline (black, opaque) in BGRA */
+#define TEXT_ATLAS_OUTLINE_PIXEL    (0xFF000000u)
+
+TextAtlas::TextAtlas()
+{
+
+}
+
+TextAtlas::~TextAtlas()
+{
+
+}
+
+/*****************************************
+* Function Name : get_style
+* Description   : Function to get the index of the text style.
+*                 The glyphs of a new style are rasterized here, so that the styles used by
+*                 the application should be requested once at startup.
+* Arguments     : font = OpenCV Hershey font face
+*                 scale = font scale
+*                 thickness = thickness of the text
+*                 outline = thickness of the black outline drawn under the text (0: none)
+* Return value  : index of the style
+******************************************/
+int32_t TextAtlas::get_style(int32_t font, float scale, int32_t thickness, int32_t outline)
+{
+    size_t i;
+
+    for (i = 0; i < styles.size(); i++)
+    {
+        if ((styles[i].font == font) && (styles[i].scale == scale)
+            && (styles[i].thickness == thickness) && (styles[i].outline == outline))
+        {
+            return (int32_t)i;
+        }
+    }
+    add_style(font, scale, thickness, outline);
+    return (int32_t)styles.size() - 1;
+}
+
+/*****************************************
+* Function Name : add_style
+* Description   : Rasterize the printable ASCII glyphs of the style with cv::putText
+*                 into the alpha masks of the atlas.
+* Arguments     : font = OpenCV Hershey font face
+*                 scale = font scale
+*                 thickness = thickness of the text
+*                 outline = thickness of the black outline drawn under the text (0: none)
+* Return value  : -
+******************************************/
+void TextAtlas::add_style(int32_t font, float scale, int32_t thickness, int32_t outline)
+{
+    text_style_t st;
+    std::string all;
+    int32_t line = std::max(thickness, outline);
+    int32_t max_w = 0;
+    int baseline = 0;
+    int32_t i;
+
+    for (i = TEXT_ATLAS_FIRST_CHAR; i <= TEXT_ATLAS_LAST_CHAR; i++)
+    {
+        all += (char)i;
+    }
+    cv::Size size = cv::getTextSize(all, font, scale, line, &baseline);
+
+    st.font = font;
+    st.scale = scale;
+    st.thickness = thickness;
+    st.outline = outline;
+    st.margin = line + 2;
+    st.ascent = size.height;
+    st.descent = baseline;
+    for (i = 0; i < TEXT_ATLAS_NUM_CHAR; i++)
+    {
+        int b = 0;
+        std::string one(1, (char)(TEXT_ATLAS_FIRST_CHAR + i));
+        max_w = std::max(max_w, cv::getTextSize(one, font, scale, line, &b).width);
+        /* getTextSize rounds the width, so the advance is measured on 64 glyphs for sub-pixel accuracy. */
+        st.advance[i] = cv::getTextSize(std::string(64, one[0]), font, scale, 0, &b).width / 64.0f;
+    }
+    /* Italic glyphs lean out of their advance. */
+    st.cell_w = max_w + st.margin * 2 + st.ascent / 2;
+    st.cell_h = st.ascent + st.descent + st.margin * 2;
+    st.fill.assign((size_t)TEXT_ATLAS_NUM_CHAR * st.cell_w * st.cell_h, 0);
+    st.border.assign((size_t)TEXT_ATLAS_NUM_CHAR * st.cell_w * st.cell_h, 0);
+
+    for (i = 0; i < TEXT_ATLAS_NUM_CHAR; i++)
+    {
+        std::string one(1, (char)(TEXT_ATLAS_FIRST_CHAR + i));
+        size_t offset = (size_t)i * st.cell_w * st.cell_h;
+        cv::Point org(st.margin, st.margin + st.ascent);
+
+        cv::Mat fill(st.cell_h, st.cell_w, CV_8UC1, st.fill.data() + offset);
+        cv::putText(fill, one, org, font, scale, cv::Scalar(255), thickness);
+        if (0 < outline)
+        {
+            cv::Mat border(st.cell_h, st.cell_w, CV_8UC1, st.border.data() + offset);
+            cv::putText(border, one, org, font, scale, cv::Scalar(255), outline);
+        }
+    }
+
+    styles.push_back(st);
+    sprites.resize(styles.size());
+}
+
+/*****************************************
+* Function Name : get_advance
+* Description   : Get the sub-pixel pen movement of the string
+* Arguments     : st = text style
+*                 str = string
+* Return value  : pen movement in pixel
+******************************************/
+float TextAtlas::get_advance(const text_style_t& st, const char* str)
+{
+    float adv = 0;
+
+    for (; *str != '\0'; str++)
+    {
+        int32_t c = (uint8_t)*str;
+        if ((c < TEXT_ATLAS_FIRST_CHAR) || (TEXT_ATLAS_LAST_CHAR < c))
+        {
+            c = '?';
+        }
+        adv += st.advance[c - TEXT_ATLAS_FIRST_CHAR];
+    }
+    return adv;
+}
+
+/*****************************************
+* Function Name : get_width
+* Description   : Get the width of the string in the same way as cv::getTextSize
+* Arguments     : style = index of the style
+*                 str = string
+* Return value  : width in pixel
+******************************************/
+int32_t TextAtlas::get_width(int32_t style, const char* str)
+{
+    const text_style_t& st = styles[style];
+    return (int32_t)std::lround(get_advance(st, str) + std::max(st.thickness, st.outline));
+}
+
+/*****************************************
+* Function Name : get_width
+* Description   : Get the width of the label followed by the value in the same way as cv::getTextSize
+* Arguments     : style = index of the style
+*                 label = fixed part of the string
+*                 value = changing part of the string
+* Return value  : width in pixel
+******************************************/
+int32_t TextAtlas::get_width(int32_t style, const char* label, const char* value)
+{
+    const text_style_t& st = styles[style];
+    return (int32_t)std::lround(get_advance(st, label) + get_advance(st, value) + std::max(st.thickness, st.outline));
+}
+
+/*****************************************
+* Function Name : get_height
+* Description   : Get the height of the text above the baseline
+* Arguments     : style = index of the style
+* Return value  : height in pixel
+******************************************/
+int32_t TextAtlas::get_height(int32_t style)
+{
+    return styles[style].ascent;
+}
+
+/*****************************************
+* Function Name : get_descent
+* Description   : Get the height of the text below the baseline
+* Arguments     : style = index of the style
+* Return value  : height in pixel
+******************************************/
+int32_t TextAtlas::get_descent(int32_t style)
+{
+    return styles[style].descent;
+}
+
+/*****************************************
+* Function Name : blit_mask
+* Description   : Write the pixel value where the glyph mask is set
+* Arguments     : dst = BGRA image
+*                 w = width of the image
+*                 h = height of the image
+*                 mask = glyph mask (cell_w x cell_h)
+*                 st = text style
+*                 x = X coordinate of the glyph origin
+*                 y = Y coordinate of the baseline
+*                 pixel = BGRA pixel value
+* Return value  : -
+******************************************/
+void TextAtlas::blit_mask(uint32_t* dst, int32_t w, int32_t h, const uint8_t* mask, const text_style_t& st,
+                          int32_t x, int32_t y, uint32_t pixel)
+{
+    int32_t left = x - st.margin;
+    int32_t top = y - st.ascent - st.margin;
+    int32_t col_start = std::max(0, -left);
+    int32_t col_end = std::min(st.cell_w, w - left);
+    int32_t row_start = std::max(0, -top);
+    int32_t row_end = std::min(st.cell_h, h - top);
+    int32_t row;
+    int32_t col;
+
+    for (row = row_start; row < row_end; row++)
+    {
+        const uint8_t* m = mask + row * st.cell_w;
+        uint32_t* d = dst + (int64_t)(top + row) * w + left;
+        for (col = col_start; col < col_end; col++)
+        {
+            if (0 != m[col])
+            {
+                d[col] = pixel;
+            }
+        }
+    }
+}
+
+/*****************************************
+* Function Name : render
+* Description   : Draw the string with the glyph masks.
+*                 The outline of the whole string is drawn first and the text on it,
+*                 in the same order as the two cv::putText calls.
+* Arguments     : dst = BGRA image
+*                 w = width of the image
+*                 h = height of the image
+*                 style = index of the style
+*                 str = string
+*                 x = X coordinate of the bottom left of the string
+*                 y = Y coordinate of the baseline
+*                 color = text color in RGB, e.g. white = 0xFFFFFF
+* Return value  : pen movement in pixel
+******************************************/
+int32_t TextAtlas::render(uint32_t* dst, int32_t w, int32_t h, int32_t style, const char* str, int32_t x, int32_t y, uint32_t color)
+{
+    const text_style_t& st = styles[style];
+    size_t cell_size = (size_t)st.cell_w * st.cell_h;
+    uint32_t pixel = 0xFF000000u | (color & 0xFFFFFFu);
+    float pen = 0;
+    const char* p;
+
+    if (0 < st.outline)
+    {
+        for (p = str, pen = 0; *p != '\0'; p++)
+        {
+            int32_t c = (uint8_t)*p;
+            if ((c < TEXT_ATLAS_FIRST_CHAR) || (TEXT_ATLAS_LAST_CHAR < c))
+            {
+                c = '?';
+            }
+            c -= TEXT_ATLAS_FIRST_CHAR;
+            blit_mask(dst, w, h, st.border.data() + c * cell_size, st, x + (int32_t)std::lround(pen), y, TEXT_ATLAS_OUTLINE_PIXEL);
+            pen += st.advance[c];
+        }
+    }
+    for (p = str, pen = 0; *p != '\0'; p++)
+    {
+        int32_t c = (uint8_t)*p;
+        if ((c < TEXT_ATLAS_FIRST_CHAR) || (TEXT_ATLAS_LAST_CHAR < c))
+        {
+            c = '?';
+        }
+        c -= TEXT_ATLAS_FIRST_CHAR;
+        blit_mask(dst, w, h, st.fill.data() + c * cell_size, st, x + (int32_t)std::lround(pen), y, pixel);
+        pen += st.advance[c];
+    }
+    return (int32_t)std::lround(pen);
+}
+
+/*****************************************
+* Function Name : draw_text
+* Description   : Draw the string on the BGRA image glyph by glyph.
+*                 Used for the strings changing every frame, e.g. numbers.
+* Arguments     : bgra = BGRA image
+*                 w = width of the image
+*                 h = height of the image
+*                 style = index of the style
+*                 str = string
+*                 x = X coordinate of the bottom left of the string
+*                 y = Y coordinate of the baseline
+*                 color = text color in RGB, e.g. white = 0xFFFFFF
+* Return value  : pen movement in pixel
+******************************************/
+int32_t TextAtlas::draw_text(uint8_t* bgra, int32_t w, int32_t h, int32_t style, const char* str, int32_t x, int32_t y, uint32_t color)
+{
+    return render((uint32_t*)bgra, w, h, style, str, x, y, color);
+}
+
+/*****************************************
+* Function Name : draw_sprite
+* Description   : Draw the fixed string (e.g. class label) on the BGRA image.
+*                 The string is rendered into a sprite at the first call for each color
+*                 and the sprite is copied afterwards.
+* Arguments     : bgra = BGRA image
+*                 w = width of the image
+*                 h = height of the image
+*                 style = index of the style
+*                 str = string
+*                 x = X coordinate of the bottom left of the string
+*                 y = Y coordinate of the baseline
+*                 color = text color in RGB, e.g. white = 0xFFFFFF
+* Return value  : pen movement in pixel
+******************************************/
+int32_t TextAtlas::draw_sprite(uint8_t* bgra, int32_t w, int32_t h, int32_t style, const char* str, int32_t x, int32_t y, uint32_t color)
+{
+    const text_style_t& st = styles[style];
+    std::map<std::string, text_sprite_t, std::less<>>& cache = sprites[style][color];
+    std::map<std::string, text_sprite_t, std::less<>>::iterator it = cache.find(str);
+    uint32_t* dst = (uint32_t*)bgra;
+    int32_t row;
+    int32_t col;
+
+    if (it == cache.end())
+    {
+        text_sprite_t sp;
+        sp.width = (int32_t)std::lround(get_advance(st, str)) + st.cell_w;
+        sp.height = st.cell_h;
+        sp.pixel.assign((size_t)sp.width * sp.height, 0);
+        sp.advance = render(sp.pixel.data(), sp.width, sp.height, style, str, st.margin, st.margin + st.ascent, color);
+        it = cache.emplace(str, std::move(sp)).first;
+    }
+
+    const text_sprite_t& sp = it->second;
+    int32_t left = x - st.margin;
+    int32_t top = y - st.ascent - st.margin;
+    int32_t col_start = std::max(0, -left);
+    int32_t col_end = std::min(sp.width, w - left);
+    int32_t row_start = std::max(0, -top);
+    int32_t row_end = std::min(sp.height, h - top);
+
+    for (row = row_start; row < row_end; row++)
+    {
+        const uint32_t* s = sp.pixel.data() + row * sp.width;
+        uint32_t* d = dst + (int64_t)(top + row) * w + left;
+        for (col = col_start; col < col_end; col++)
+        {
+            if (0 != s[col])
+            {
+                d[col] = s[col];
+            }
+        }
+    }
+    return sp.advance;
+}
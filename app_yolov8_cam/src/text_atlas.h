@@ -0,0 +1,72 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : text_atlas.h
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for Ultralytics Detection YOLOv8 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+#ifndef TEXT_ATLAS_H
+#define TEXT_ATLAS_H
+
+#include "define.h"
+
+/* Printable ASCII characters rasterized in the atlas */
+#define TEXT_ATLAS_FIRST_CHAR       (0x20)
+#define TEXT_ATLAS_LAST_CHAR        (0x7E)
+#define TEXT_ATLAS_NUM_CHAR         (TEXT_ATLAS_LAST_CHAR - TEXT_ATLAS_FIRST_CHAR + 1)
+
+/* Glyph masks of one text style (font, scale and thickness) */
+typedef struct text_style
+{
+    int32_t font;               /* OpenCV Hershey font face */
+    float scale;                /* font scale */
+    int32_t thickness;          /* thickness of the text */
+    int32_t outline;            /* thickness of the black outline drawn under the text (0: none) */
+    int32_t margin;             /* pixels around the glyph origin in a cell */
+    int32_t ascent;             /* pixels above the baseline */
+    int32_t descent;            /* pixels below the baseline */
+    int32_t cell_w;             /* width of a glyph cell */
+    int32_t cell_h;             /* height of a glyph cell */
+    float advance[TEXT_ATLAS_NUM_CHAR];     /* sub-pixel advance of each glyph */
+    std::vector<uint8_t> fill;              /* alpha mask of the text, cell_w x cell_h per glyph */
+    std::vector<uint8_t> border;            /* alpha mask of the outline, cell_w x cell_h per glyph */
+} text_style_t;
+
+/* Pre-rendered BGRA image of a fixed string (e.g. class label) */
+typedef struct text_sprite
+{
+    int32_t width;
+    int32_t height;
+    int32_t advance;            /* pen movement after the string */
+    std::vector<uint32_t> pixel;            /* BGRA, 0 is transparent */
+} text_sprite_t;
+
+class TextAtlas
+{
+    public:
+        TextAtlas();
+        ~TextAtlas();
+
+        int32_t get_style(int32_t font, float scale, int32_t thickness, int32_t outline);
+        int32_t get_width(int32_t style, const char* str);
+        int32_t get_width(int32_t style, const char* label, const char* value);
+        int32_t get_height(int32_t style);
+        int32_t get_descent(int32_t style);
+        int32_t draw_text(uint8_t* bgra, int32_t w, int32_t h, int32_t style, const char* str, int32_t x, int32_t y, uint32_t color);
+        int32_t draw_sprite(uint8_t* bgra, int32_t w, int32_t h, int32_t style, const char* str, int32_t x, int32_t y, uint32_t color);
+
+    private:
+        std::vector<text_style_t> styles;
+        /* Sprites of each style, looked up by color and string (std::less<> to find with const char*) */
+        std::vector<std::map<uint32_t, std::map<std::string, text_sprite_t, std::less<>>>> sprites;
+
+        void add_style(int32_t font, float scale, int32_t thickness, int32_t outline);
+        float get_advance(const text_style_t& st, const char* str);
+        void blit_mask(uint32_t* dst, int32_t w, int32_t h, const uint8_t* mask, const text_style_t& st,
+                       int32_t x, int32_t y, uint32_t pixel);
+        int32_t render(uint32_t* dst, int32_t w, int32_t h, int32_t style, const char* str, int32_t x, int32_t y, uint32_t color);
+};
+
+#endif
@@ -0,0 +1,196 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : worker_pool.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for Ultralytics Detection YOLOv8 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "worker_pool.h"
+#include <pthread.h>
+
+using namespace std;
+
+WorkerPool::WorkerPool()
+{
+    next_chunk.store(0);
+}
+
+WorkerPool::~WorkerPool()
+{
+    stop();
+}
+
+/*****************************************
+* Function Name : start
+* Description   : Start the worker threads. The threads are kept until stop().
+* Arguments     : num_worker = number of the worker threads
+*                 cores = CPU core on which each worker thread is pinned (-1: not pinned)
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t WorkerPool::start(uint32_t num_worker, const int32_t* cores)
+{
+    int32_t ret = 0;
+    cpu_set_t cpu_set;
+
+    for (uint32_t i = 0; i < num_worker; i++)
+    {
+        try
+        {
+            workers.emplace_back(&WorkerPool::worker_loop, this);
+        }
+        catch (const system_error& e)
+        {
+            fprintf(stderr, "[ERROR] Failed to create the worker thread %d: %s\n", i, e.what());
+            return -1;
+        }
+
+        if (NULL != cores && 0 <= cores[i])
+        {
+            CPU_ZERO(&cpu_set);
+            CPU_SET(cores[i], &cpu_set);
+            ret = pthread_setaffinity_np(workers[i].native_handle(), sizeof(cpu_set_t), &cpu_set);
+            if (0 != ret)
+            {
+                /* The worker thread still works without pinning. */
+                fprintf(stderr, "[WARNING] Failed to pin the worker thread %d to CPU %d: errno=%d\n", i, cores[i], ret);
+            }
+        }
+    }
+    return 0;
+}
+
+/*****************************************
+* Function Name : stop
+* Description   : Stop and join the worker threads.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void WorkerPool::stop()
+{
+    {
+        lock_guard<mutex> lock(mtx);
+        stop_req = true;
+    }
+    cv_start.notify_all();
+
+    for (thread& t : workers)
+    {
+        if (t.joinable())
+        {
+            t.join();
+        }
+    }
+    workers.clear();
+}
+
+/*****************************************
+* Function Name : get_num_worker
+* Description   : Get the number of the worker threads.
+* Arguments     : -
+* Return value  : number of the worker threads
+******************************************/
+uint32_t WorkerPool::get_num_worker()
+{
+    return workers.size();
+}
+
+/*****************************************
+* Function Name : run
+* Description   : Run job(ctx, 0) ... job(ctx, num_chunk - 1) on the worker threads and the caller thread.
+*                 The chunks are taken one by one by the thread that becomes free first,
+*                 and this function returns after all chunks are finished (frame barrier).
+*                 Nothing is allocated, so that it can be called every frame.
+* Arguments     : job = function to process one chunk
+*                 ctx = context given to job
+*                 num_chunk = number of the chunks
+* Return value  : -
+******************************************/
+void WorkerPool::run(worker_job_t job, void* ctx, uint32_t num_chunk)
+{
+    uint32_t done = 0;
+    unique_lock<mutex> lock(mtx);
+
+    /* Wait for the workers that woke up late for the previous job. */
+    cv_done.wait(lock, [this]{ return 0 == busy; });
+
+    this->job = job;
+    job_ctx = ctx;
+    this->num_chunk = num_chunk;
+    done_chunk = 0;
+    next_chunk.store(0);
+    generation++;
+    lock.unlock();
+    cv_start.notify_all();
+
+    /* The caller thread also processes the chunks. */
+    done = process_chunks(job, ctx, num_chunk);
+
+    lock.lock();
+    done_chunk += done;
+    cv_done.wait(lock, [this]{ return (this->num_chunk == done_chunk) && (0 == busy); });
+}
+
+/*****************************************
+* Function Name : worker_loop
+* Description   : Main loop of the worker threads.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void WorkerPool::worker_loop()
+{
+    uint64_t seen = 0;
+    uint32_t done = 0;
+    worker_job_t f = NULL;
+    void* ctx = NULL;
+    uint32_t num = 0;
+    unique_lock<mutex> lock(mtx);
+
+    while (1)
+    {
+        cv_start.wait(lock, [&]{ return stop_req || (generation != seen); });
+        if (stop_req)
+        {
+            break;
+        }
+        seen = generation;
+        f = job;
+        ctx = job_ctx;
+        num = num_chunk;
+        busy++;
+        lock.unlock();
+
+        done = process_chunks(f, ctx, num);
+
+        lock.lock();
+        busy--;
+        done_chunk += done;
+        cv_done.notify_all();
+    }
+}
+
+/*****************************************
+* Function Name : process_chunks
+* Description   : Process the chunks until no chunk is left.
+* Arguments     : f = function to process one chunk
+*                 ctx = context given to f
+*                 num = number of the chunks
+* Return value  : number of the chunks processed by this thread
+******************************************/
+uint32_t WorkerPool::process_chunks(worker_job_t f, void* ctx, uint32_t num)
+{
+    uint32_t done = 0;
+    uint32_t chunk = 0;
+
+    while ((chunk = next_chunk.fetch_add(1)) < num)
+    {
+        f(ctx, chunk);
+        done++;
+    }
+    return done;
+}
@@ -0,0 +1,408 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : yuyv_convert.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for Ultralytics Detection YOLOv8 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "yuyv_convert.h"
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/* Number of YUYV pixel pairs converted per SIMD iteration */
+#if defined(__ARM_NEON) || defined(__AVX2__)
+#define YUYV_BLOCK_PAIR     (16)
+#elif defined(__SSE2__)
+#define YUYV_BLOCK_PAIR     (8)
+#else
+#define YUYV_BLOCK_PAIR     (1)
+#endif
+
+#if defined(__ARM_NEON)
+/*****************************************
+* Function Name : neon_yuyv_channel
+* Description   : Add the Y term to the chroma term of one color channel and
+*                 narrow it to uint8_t with rounding and saturation.
+* Arguments     : y = (Y - 16) of 8 pixels
+*                 c_lo = chroma term of the lower 4 pixels
+*                 c_hi = chroma term of the upper 4 pixels
+* Return value  : channel value of 8 pixels
+******************************************/
+static inline uint8x8_t neon_yuyv_channel(int16x8_t y, int32x4_t c_lo, int32x4_t c_hi)
+{
+    int32x4_t lo = vmlal_n_s16(c_lo, vget_low_s16(y), 298);
+    int32x4_t hi = vmlal_n_s16(c_hi, vget_high_s16(y), 298);
+    /* (x + 128) >> 8, clipped to [0, 255] */
+    return vqmovn_u16(vcombine_u16(vqrshrun_n_s32(lo, 8), vqrshrun_n_s32(hi, 8)));
+}
+
+/*****************************************
+* Function Name : neon_yuyv_pairs
+* Description   : Convert 8 deinterleaved YUYV pixel pairs into B, G, R channels.
+* Arguments     : y0 = Y of the even pixels
+*                 u = U of the pairs
+*                 y1 = Y of the odd pixels
+*                 v = V of the pairs
+*                 out = B, G, R of the even pixels followed by B, G, R of the odd pixels
+* Return value  : -
+******************************************/
+static inline void neon_yuyv_pairs(uint8x8_t y0, uint8x8_t u, uint8x8_t y1, uint8x8_t v, uint8x8_t* out)
+{
+    int16x8_t sy0 = vreinterpretq_s16_u16(vsubl_u8(y0, vdup_n_u8(16)));
+    int16x8_t sy1 = vreinterpretq_s16_u16(vsubl_u8(y1, vdup_n_u8(16)));
+    int16x8_t su  = vreinterpretq_s16_u16(vsubl_u8(u, vdup_n_u8(128)));
+    int16x8_t sv  = vreinterpretq_s16_u16(vsubl_u8(v, vdup_n_u8(128)));
+
+    int32x4_t cb_lo = vmull_n_s16(vget_low_s16(su), 516);
+    int32x4_t cb_hi = vmull_n_s16(vget_high_s16(su), 516);
+    int32x4_t cg_lo = vmlal_n_s16(vmull_n_s16(vget_low_s16(su), -100), vget_low_s16(sv), -208);
+    int32x4_t cg_hi = vmlal_n_s16(vmull_n_s16(vget_high_s16(su), -100), vget_high_s16(sv), -208);
+    int32x4_t cr_lo = vmull_n_s16(vget_low_s16(sv), 409);
+    int32x4_t cr_hi = vmull_n_s16(vget_high_s16(sv), 409);
+
+    out[0] = neon_yuyv_channel(sy0, cb_lo, cb_hi);
+    out[1] = neon_yuyv_channel(sy0, cg_lo, cg_hi);
+    out[2] = neon_yuyv_channel(sy0, cr_lo, cr_hi);
+    out[3] = neon_yuyv_channel(sy1, cb_lo, cb_hi);
+    out[4] = neon_yuyv_channel(sy1, cg_lo, cg_hi);
+    out[5] = neon_yuyv_channel(sy1, cr_lo, cr_hi);
+}
+
+/*****************************************
+* Function Name : yuyv_to_bgra_block
+* Description   : Convert 16 YUYV pixel pairs (64 bytes) into 32 BGRA pixels (128 bytes).
+*                 All input bytes are loaded before the first store.
+* Arguments     : src = YUYV pixel pairs
+*                 dst = BGRA pixels
+* Return value  : -
+******************************************/
+static inline void yuyv_to_bgra_block(const uint8_t* src, uint8_t* dst)
+{
+    uint8x16x4_t in = vld4q_u8(src);
+    uint8x8_t lo[6];
+    uint8x8_t hi[6];
+
+    neon_yuyv_pairs(vget_low_u8(in.val[0]), vget_low_u8(in.val[1]),
+                    vget_low_u8(in.val[2]), vget_low_u8(in.val[3]), lo);
+    neon_yuyv_pairs(vget_high_u8(in.val[0]), vget_high_u8(in.val[1]),
+                    vget_high_u8(in.val[2]), vget_high_u8(in.val[3]), hi);
+
+    /* Interleave the even and odd pixels back into the pixel order. */
+    uint8x16x2_t b = vzipq_u8(vcombine_u8(lo[0], hi[0]), vcombine_u8(lo[3], hi[3]));
+    uint8x16x2_t g = vzipq_u8(vcombine_u8(lo[1], hi[1]), vcombine_u8(lo[4], hi[4]));
+    uint8x16x2_t r = vzipq_u8(vcombine_u8(lo[2], hi[2]), vcombine_u8(lo[5], hi[5]));
+    uint8x16_t a = vdupq_n_u8(255);
+
+    uint8x16x4_t out0 = {{ b.val[0], g.val[0], r.val[0], a }};
+    uint8x16x4_t out1 = {{ b.val[1], g.val[1], r.val[1], a }};
+    vst4q_u8(dst, out0);
+    vst4q_u8(dst + 64, out1);
+}
+#elif defined(__AVX2__)
+/*****************************************
+* Function Name : avx2_yuyv_pixels
+* Description   : Convert 16 YUYV pixels (one 256-bit register) into B, G, R channels in int16_t.
+*                 Each 128-bit lane holds 8 pixels.
+* Arguments     : in = YUYV pixels
+*                 b = blue channel
+*                 g = green channel
+*                 r = red channel
+* Return value  : -
+******************************************/
+static inline void avx2_yuyv_pixels(__m256i in, __m256i* b, __m256i* g, __m256i* r)
+{
+    const __m256i coef_b = _mm256_set1_epi32((516 << 16) | 298);
+    const __m256i coef_g = _mm256_set1_epi32((int32_t)(((uint32_t)(-100) << 16) | 298));
+    const __m256i coef_gv = _mm256_set1_epi32((128 << 16) | (uint16_t)(-208));
+    const __m256i coef_r = _mm256_set1_epi32((409 << 16) | 298);
+    const __m256i round = _mm256_set1_epi32(128);
+    const __m256i one = _mm256_set1_epi16(1);
+
+    __m256i y = _mm256_sub_epi16(_mm256_and_si256(in, _mm256_set1_epi16(0x00FF)), _mm256_set1_epi16(16));
+    __m256i uv = _mm256_sub_epi16(_mm256_srli_epi16(in, 8), _mm256_set1_epi16(128));
+    /* Duplicate U and V of each pair for both pixels. */
+    __m256i u = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(uv, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 2, 0, 0));
+    __m256i v = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(uv, _MM_SHUFFLE(3, 3, 1, 1)), _MM_SHUFFLE(3, 3, 1, 1));
+
+    __m256i yu_lo = _mm256_unpacklo_epi16(y, u);
+    __m256i yu_hi = _mm256_unpackhi_epi16(y, u);
+    __m256i yv_lo = _mm256_unpacklo_epi16(y, v);
+    __m256i yv_hi = _mm256_unpackhi_epi16(y, v);
+    __m256i v1_lo = _mm256_unpacklo_epi16(v, one);
+    __m256i v1_hi = _mm256_unpackhi_epi16(v, one);
+
+    __m256i b_lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yu_lo, coef_b), round), 8);
+    __m256i b_hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yu_hi, coef_b), round), 8);
+    __m256i g_lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yu_lo, coef_g), _mm256_madd_epi16(v1_lo, coef_gv)), 8);
+    __m256i g_hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yu_hi, coef_g), _mm256_madd_epi16(v1_hi, coef_gv)), 8);
+    __m256i r_lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yv_lo, coef_r), round), 8);
+    __m256i r_hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yv_hi, coef_r), round), 8);
+
+    *b = _mm256_packs_epi32(b_lo, b_hi);
+    *g = _mm256_packs_epi32(g_lo, g_hi);
+    *r = _mm256_packs_epi32(r_lo, r_hi);
+}
+
+/*****************************************
+* Function Name : yuyv_to_bgra_block
+* Description   : Convert 16 YUYV pixel pairs (64 bytes) into 32 BGRA pixels (128 bytes).
+*                 All input bytes are loaded before the first store.
+* Arguments     : src = YUYV pixel pairs
+*                 dst = BGRA pixels
+* Return value  : -
+******************************************/
+static inline void yuyv_to_bgra_block(const uint8_t* src, uint8_t* dst)
+{
+    __m256i in0 = _mm256_loadu_si256((const __m256i*)src);
+    __m256i in1 = _mm256_loadu_si256((const __m256i*)(src + 32));
+    __m256i b0, g0, r0, b1, g1, r1;
+
+    avx2_yuyv_pixels(in0, &b0, &g0, &r0);
+    avx2_yuyv_pixels(in1, &b1, &g1, &r1);
+
+    /* lane0 = pixel 0-7, 16-23 / lane1 = pixel 8-15, 24-31 */
+    __m256i b = _mm256_packus_epi16(b0, b1);
+    __m256i g = _mm256_packus_epi16(g0, g1);
+    __m256i r = _mm256_packus_epi16(r0, r1);
+    __m256i a = _mm256_set1_epi8((char)0xFF);
+
+    __m256i bg_lo = _mm256_unpacklo_epi8(b, g);
+    __m256i bg_hi = _mm256_unpackhi_epi8(b, g);
+    __m256i ra_lo = _mm256_unpacklo_epi8(r, a);
+    __m256i ra_hi = _mm256_unpackhi_epi8(r, a);
+
+    __m256i p0 = _mm256_unpacklo_epi16(bg_lo, ra_lo);   /* pixel 0-3,   8-11  */
+    __m256i p1 = _mm256_unpackhi_epi16(bg_lo, ra_lo);   /* pixel 4-7,   12-15 */
+    __m256i p2 = _mm256_unpacklo_epi16(bg_hi, ra_hi);   /* pixel 16-19, 24-27 */
+    __m256i p3 = _mm256_unpackhi_epi16(bg_hi, ra_hi);   /* pixel 20-23, 28-31 */
+
+    _mm256_storeu_si256((__m256i*)dst,         _mm256_permute2x128_si256(p0, p1, 0x20));
+    _mm256_storeu_si256((__m256i*)(dst + 32),  _mm256_permute2x128_si256(p0, p1, 0x31));
+    _mm256_storeu_si256((__m256i*)(dst + 64),  _mm256_permute2x128_si256(p2, p3, 0x20));
+    _mm256_storeu_si256((__m256i*)(dst + 96),  _mm256_permute2x128_si256(p2, p3, 0x31));
+}
+#elif defined(__SSE2__)
+/*****************************************
+* Function Name : sse_yuyv_pixels
+* Description   : Convert 8 YUYV pixels (one 128-bit register) into B, G, R channels in int16_t.
+* Arguments     : in = YUYV pixels
+*                 b = blue channel
+*                 g = green channel
+*                 r = red channel
+* Return value  : -
+******************************************/
+static inline void sse_yuyv_pixels(__m128i in, __m128i* b, __m128i* g, __m128i* r)
+{
+    const __m128i coef_b = _mm_set1_epi32((516 << 16) | 298);
+    const __m128i coef_g = _mm_set1_epi32((int32_t)(((uint32_t)(-100) << 16) | 298));
+    const __m128i coef_gv = _mm_set1_epi32((128 << 16) | (uint16_t)(-208));
+    const __m128i coef_r = _mm_set1_epi32((409 << 16) | 298);
+    const __m128i round = _mm_set1_epi32(128);
+    const __m128i one = _mm_set1_epi16(1);
+
+    __m128i y = _mm_sub_epi16(_mm_and_si128(in, _mm_set1_epi16(0x00FF)), _mm_set1_epi16(16));
+    __m128i uv = _mm_sub_epi16(_mm_srli_epi16(in, 8), _mm_set1_epi16(128));
+    /* Duplicate U and V of each pair for both pixels. */
+    __m128i u = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 2, 0, 0));
+    __m128i v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(3, 3, 1, 1)), _MM_SHUFFLE(3, 3, 1, 1));
+
+    __m128i yu_lo = _mm_unpacklo_epi16(y, u);
+    __m128i yu_hi = _mm_unpackhi_epi16(y, u);
+    __m128i yv_lo = _mm_unpacklo_epi16(y, v);
+    __m128i yv_hi = _mm_unpackhi_epi16(y, v);
+    __m128i v1_lo = _mm_unpacklo_epi16(v, one);
+    __m128i v1_hi = _mm_unpackhi_epi16(v, one);
+
+    __m128i b_lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yu_lo, coef_b), round), 8);
+    __m128i b_hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yu_hi, coef_b), round), 8);
+    __m128i g_lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yu_lo, coef_g), _mm_madd_epi16(v1_lo, coef_gv)), 8);
+    __m128i g_hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yu_hi, coef_g), _mm_madd_epi16(v1_hi, coef_gv)), 8);
+    __m128i r_lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yv_lo, coef_r), round), 8);
+    __m128i r_hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yv_hi, coef_r), round), 8);
+
+    *b = _mm_packs_epi32(b_lo, b_hi);
+    *g = _mm_packs_epi32(g_lo, g_hi);
+    *r = _mm_packs_epi32(r_lo, r_hi);
+}
+
+/*****************************************
+* Function Name : yuyv_to_bgra_block
+* Description   : Convert 8 YUYV pixel pairs (32 bytes) into 16 BGRA pixels (64 bytes).
+*                 All input bytes are loaded before the first store.
+* Arguments     : src = YUYV pixel pairs
+*                 dst = BGRA pixels
+* Return value  : -
+******************************************/
+static inline void yuyv_to_bgra_block(const uint8_t* src, uint8_t* dst)
+{
+    __m128i in0 = _mm_loadu_si128((const __m128i*)src);
+    __m128i in1 = _mm_loadu_si128((const __m128i*)(src + 16));
+    __m128i b0, g0, r0, b1, g1, r1;
+
+    sse_yuyv_pixels(in0, &b0, &g0, &r0);
+    sse_yuyv_pixels(in1, &b1, &g1, &r1);
+
+    __m128i b = _mm_packus_epi16(b0, b1);
+    __m128i g = _mm_packus_epi16(g0, g1);
+    __m128i r = _mm_packus_epi16(r0, r1);
+    __m128i a = _mm_set1_epi8((char)0xFF);
+
+    __m128i bg_lo = _mm_unpacklo_epi8(b, g);
+    __m128i bg_hi = _mm_unpackhi_epi8(b, g);
+    __m128i ra_lo = _mm_unpacklo_epi8(r, a);
+    __m128i ra_hi = _mm_unpackhi_epi8(r, a);
+
+    _mm_storeu_si128((__m128i*)dst,        _mm_unpacklo_epi16(bg_lo, ra_lo));
+    _mm_storeu_si128((__m128i*)(dst + 16), _mm_unpackhi_epi16(bg_lo, ra_lo));
+    _mm_storeu_si128((__m128i*)(dst + 32), _mm_unpacklo_epi16(bg_hi, ra_hi));
+    _mm_storeu_si128((__m128i*)(dst + 48), _mm_unpackhi_epi16(bg_hi, ra_hi));
+}
+#else
+/*****************************************
+* Function Name : yuyv_to_bgra_block
+* Description   : Convert 1 YUYV pixel pair into 2 BGRA pixels.
+* Arguments     : src = YUYV pixel pair
+*                 dst = BGRA pixels
+* Return value  : -
+******************************************/
+static inline void yuyv_to_bgra_block(const uint8_t* src, uint8_t* dst)
+{
+    yuyv_to_bgra_pair(src, dst);
+}
+#endif
+
+/*****************************************
+* Function Name : yuyv_to_bgra
+* Description   : Convert the YUYV image into the BGRA image.
+*                 Arm (RZ/V2H) : NEON vld4/vst4, 32 pixels per iteration
+*                 x86 with AVX2: 32 pixels per iteration
+*                 x86 SSE2     : 16 pixels per iteration
+*                 The remaining pixels are converted by yuyv_to_bgra_pair.
+*                 The image is converted from the last pixel to the first one,
+*                 so that dst may be the same buffer as src (in-place conversion):
+*                 the BGRA output of a pixel never overwrites YUYV input that is not read yet.
+* Arguments     : src = YUYV image
+*                 dst = BGRA image (same as src, or not overlapping with src)
+*                 num_pixel = number of pixels (even number)
+* Return value  : -
+******************************************/
+void yuyv_to_bgra(const uint8_t* src, uint8_t* dst, int64_t num_pixel)
+{
+    int64_t num_pair = num_pixel / 2;
+    int64_t num_block = num_pair / YUYV_BLOCK_PAIR;
+    int64_t i;
+
+    /* Remaining pixel pairs at the end of the image */
+    for (i = num_pair - 1; i >= num_block * YUYV_BLOCK_PAIR; i--)
+    {
+        yuyv_to_bgra_pair(src + i * 4, dst + i * 8);
+    }
+    for (i = num_block - 1; i >= 0; i--)
+    {
+        yuyv_to_bgra_block(src + i * YUYV_BLOCK_PAIR * 4, dst + i * YUYV_BLOCK_PAIR * 8);
+    }
+}
+
+/*****************************************
+* Function Name : bgra_duplicate_pixel
+* Description   : Write one BGRA pixel as 2x2 pixels into two rows.
+* Arguments     : src = BGRA pixel
+*                 dst0 = upper row of the output
+*                 dst1 = lower row of the output
+* Return value  : -
+******************************************/
+static inline void bgra_duplicate_pixel(const uint8_t* src, uint8_t* dst0, uint8_t* dst1)
+{
+    memcpy(dst0,     src, 4);
+    memcpy(dst0 + 4, src, 4);
+    memcpy(dst1,     src, 4);
+    memcpy(dst1 + 4, src, 4);
+}
+
+/*****************************************
+* Function Name : bgra_duplicate
+* Description   : Write each BGRA pixel of one block as 2x2 pixels into two rows.
+* Arguments     : src = BGRA pixels (YUYV_BLOCK_PAIR * 2 pixels)
+*                 dst0 = upper row of the output
+*                 dst1 = lower row of the output
+* Return value  : -
+******************************************/
+static inline void bgra_duplicate(const uint8_t* src, uint8_t* dst0, uint8_t* dst1)
+{
+    int32_t i;
+
+#if defined(__ARM_NEON)
+    for (i = 0; i < YUYV_BLOCK_PAIR * 2; i += 4)
+    {
+        uint32x4_t p = vld1q_u32((const uint32_t*)(src + i * 4));
+        uint32x4x2_t d = vzipq_u32(p, p);
+        vst1q_u32((uint32_t*)(dst0 + i * 8),      d.val[0]);
+        vst1q_u32((uint32_t*)(dst0 + i * 8 + 16), d.val[1]);
+        vst1q_u32((uint32_t*)(dst1 + i * 8),      d.val[0]);
+        vst1q_u32((uint32_t*)(dst1 + i * 8 + 16), d.val[1]);
+    }
+#elif defined(__SSE2__)
+    for (i = 0; i < YUYV_BLOCK_PAIR * 2; i += 4)
+    {
+        __m128i p = _mm_loadu_si128((const __m128i*)(src + i * 4));
+        __m128i lo = _mm_unpacklo_epi32(p, p);
+        __m128i hi = _mm_unpackhi_epi32(p, p);
+        _mm_storeu_si128((__m128i*)(dst0 + i * 8),      lo);
+        _mm_storeu_si128((__m128i*)(dst0 + i * 8 + 16), hi);
+        _mm_storeu_si128((__m128i*)(dst1 + i * 8),      lo);
+        _mm_storeu_si128((__m128i*)(dst1 + i * 8 + 16), hi);
+    }
+#else
+    for (i = 0; i < YUYV_BLOCK_PAIR * 2; i++)
+    {
+        bgra_duplicate_pixel(src + i * 4, dst0 + i * 8, dst1 + i * 8);
+    }
+#endif
+}
+
+/*****************************************
+* Function Name : yuyv_to_bgra_upscale2
+* Description   : Convert the YUYV image into the BGRA image upscaled by 2 (nearest neighbor).
+*                 Each block of YUYV pixels is converted into a small BGRA buffer on the stack
+*                 and written as 2x2 pixels into the output, so that the YUYV image is read once
+*                 and the output is written once.
+* Arguments     : src = YUYV image
+*                 dst = top left pixel of the upscaled image in the BGRA output
+*                 width = width of the YUYV image (even number)
+*                 height = height of the YUYV image
+*                 dst_stride = bytes of one row of the BGRA output
+* Return value  : -
+******************************************/
+void yuyv_to_bgra_upscale2(const uint8_t* src, uint8_t* dst, int64_t width, int64_t height, int64_t dst_stride)
+{
+    uint8_t bgra[YUYV_BLOCK_PAIR * 8];
+    int64_t x;
+    int64_t y;
+
+    for (y = 0; y < height; y++)
+    {
+        const uint8_t* row = src + y * width * 2;
+        uint8_t* dst0 = dst + y * 2 * dst_stride;
+        uint8_t* dst1 = dst0 + dst_stride;
+
+        for (x = 0; x + YUYV_BLOCK_PAIR * 2 <= width; x += YUYV_BLOCK_PAIR * 2)
+        {
+            yuyv_to_bgra_block(row + x * 2, bgra);
+            bgra_duplicate(bgra, dst0 + x * 8, dst1 + x * 8);
+        }
+        for (; x + 2 <= width; x += 2)
+        {
+            yuyv_to_bgra_pair(row + x * 2, bgra);
+            bgra_duplicate_pixel(bgra,     dst0 + x * 8,      dst1 + x * 8);
+            bgra_duplicate_pixel(bgra + 4, dst0 + x * 8 + 8,  dst1 + x * 8 + 8);
+        }
+    }
+}
@@ -0,0 +1,63 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : yuyv_convert.h
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for Ultralytics Detection YOLOv8 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+#ifndef YUYV_CONVERT_H
+#define YUYV_CONVERT_H
+
+#include "define.h"
+
+/*****************************************
+* Function Name     : yuyv_clip
+* Description       : Clip the value into the range of uint8_t.
+* Arguments         : value = value to be clipped
+* Return value      : clipped value
+******************************************/
+inline uint8_t yuyv_clip(int32_t value)
+{
+    if (value > 255)
+    {
+        value = 255;
+    }
+    if (value < 0)
+    {
+        value = 0;
+    }
+    return (uint8_t)value;
+}
+
+/*****************************************
+* Function Name     : yuyv_to_bgra_pair
+* Description       : Convert one YUYV pixel pair (4 bytes) into two BGRA pixels (8 bytes)
+*                     with the BT.601 fixed point formula.
+*                     The 4 input bytes are read before writing, so that dst may overlap src.
+* Arguments         : src = YUYV pixel pair
+*                     dst = BGRA pixels
+* Return value      : -
+******************************************/
+inline void yuyv_to_bgra_pair(const uint8_t* src, uint8_t* dst)
+{
+    int32_t y0 = (int32_t)src[0] - 16;
+    int32_t u0 = (int32_t)src[1] - 128;
+    int32_t y1 = (int32_t)src[2] - 16;
+    int32_t v0 = (int32_t)src[3] - 128;
+
+    dst[0] = yuyv_clip((298 * y0 + 516 * u0 + 128) >> 8);               /* blue  */
+    dst[1] = yuyv_clip((298 * y0 - 100 * u0 - 208 * v0 + 128) >> 8);    /* green */
+    dst[2] = yuyv_clip((298 * y0 + 409 * v0 + 128) >> 8);               /* red   */
+    dst[3] = 255;
+    dst[4] = yuyv_clip((298 * y1 + 516 * u0 + 128) >> 8);               /* blue  */
+    dst[5] = yuyv_clip((298 * y1 - 100 * u0 - 208 * v0 + 128) >> 8);    /* green */
+    dst[6] = yuyv_clip((298 * y1 + 409 * v0 + 128) >> 8);               /* red   */
+    dst[7] = 255;
+}
+
+void yuyv_to_bgra(const uint8_t* src, uint8_t* dst, int64_t num_pixel);
+void yuyv_to_bgra_upscale2(const uint8_t* src, uint8_t* dst, int64_t width, int64_t height, int64_t dst_stride);
+
+#endif
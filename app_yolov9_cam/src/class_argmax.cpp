@@ -0,0 +1,105 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : class_argmax.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for WongKinYu Detection YOLOv9 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "class_argmax.h"
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/*****************************************
+* Function Name : class_argmax
+* Description   : Class-major max/argmax over the grid cells.
+*                 Each class row is read contiguously, keeping the running max score
+*                 and class of the cells in vector lanes.
+*                 Arm (RZ/V2H) : NEON, 4 cells per iteration
+*                 x86          : AVX 8 cells or SSE2 4 cells per iteration
+*                 The first class wins when the scores are the same.
+* Arguments     : cls = first cell of the class array (num_class, cells)
+*                 class_step = distance between two class rows
+*                 num_class = number of classes
+*                 num_cell = number of cells to be processed
+*                 max_score = max score of each cell
+*                 max_class = class having the max score of each cell
+* Return value  : -
+******************************************/
+void class_argmax(const float* cls, int64_t class_step, int32_t num_class, int32_t num_cell,
+                  float* max_score, int32_t* max_class)
+{
+    int32_t i = 0;
+    int32_t c = 0;
+
+#if defined(__ARM_NEON)
+    for (; i + 4 <= num_cell; i += 4)
+    {
+        float32x4_t vmax = vld1q_f32(cls + i);
+        int32x4_t vcls = vdupq_n_s32(0);
+        for (c = 1; c < num_class; c++)
+        {
+            float32x4_t v = vld1q_f32(cls + c * class_step + i);
+            uint32x4_t gt = vcgtq_f32(v, vmax);
+            vmax = vbslq_f32(gt, v, vmax);
+            vcls = vbslq_s32(gt, vdupq_n_s32(c), vcls);
+        }
+        vst1q_f32(max_score + i, vmax);
+        vst1q_s32(max_class + i, vcls);
+    }
+#elif defined(__AVX__)
+    for (; i + 8 <= num_cell; i += 8)
+    {
+        __m256 vmax = _mm256_loadu_ps(cls + i);
+        __m256 vcls = _mm256_setzero_ps();
+        for (c = 1; c < num_class; c++)
+        {
+            __m256 v = _mm256_loadu_ps(cls + c * class_step + i);
+            __m256 gt = _mm256_cmp_ps(v, vmax, _CMP_GT_OQ);
+            vmax = _mm256_blendv_ps(vmax, v, gt);
+            vcls = _mm256_blendv_ps(vcls, _mm256_set1_ps((float)c), gt);
+        }
+        _mm256_storeu_ps(max_score + i, vmax);
+        _mm256_storeu_si256((__m256i*)(max_class + i), _mm256_cvtps_epi32(vcls));
+    }
+#elif defined(__SSE2__)
+    for (; i + 4 <= num_cell; i += 4)
+    {
+        __m128 vmax = _mm_loadu_ps(cls + i);
+        __m128i vcls = _mm_setzero_si128();
+        for (c = 1; c < num_class; c++)
+        {
+            __m128 v = _mm_loadu_ps(cls + c * class_step + i);
+            __m128 gt = _mm_cmpgt_ps(v, vmax);
+            __m128i gti = _mm_castps_si128(gt);
+            vmax = _mm_or_ps(_mm_and_ps(gt, v), _mm_andnot_ps(gt, vmax));
+            vcls = _mm_or_si128(_mm_and_si128(gti, _mm_set1_epi32(c)), _mm_andnot_si128(gti, vcls));
+        }
+        _mm_storeu_ps(max_score + i, vmax);
+        _mm_storeu_si128((__m128i*)(max_class + i), vcls);
+    }
+#endif
+    for (; i < num_cell; i++)
+    {
+        float vmax = cls[i];
+        int32_t vcls = 0;
+        for (c = 1; c < num_class; c++)
+        {
+            float v = cls[c * class_step + i];
+            if (v > vmax)
+            {
+                vmax = v;
+                vcls = c;
+            }
+        }
+        max_score[i] = vmax;
+        max_class[i] = vcls;
+    }
+}
@@ -0,0 +1,115 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : det_shm.h
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for WongKinYu Detection YOLOv9 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+#ifndef DET_SHM_H
+#define DET_SHM_H
+
+#include "define.h"
+#include <string>
+
+/*****************************************
+* Detection shared memory
+*  [det_shm_header] [record 0] [record 1] ... [record (slot_num - 1)]
+*  Each record is header.record_size bytes (det_shm_record).
+*  The n-th published frame (n = 0, 1, ...) is in record (n % slot_num),
+*  and header.num_published is n + 1 after it is published.
+*  A record is guarded by its sequence counter, which is odd while the writer updates the record.
+*  A reader copies the frame and retries if the counter was odd or has changed during the copy.
+******************************************/
+#define DET_SHM_MAGIC               "DRPAISHM"
+#define DET_SHM_VERSION             (1)
+/* Max number of boxes in a record. The boxes after this are not published. */
+#define DET_SHM_MAX_BOX             (128)
+/* Alignment of the header and the records (cache line) */
+#define DET_SHM_ALIGN               (64)
+
+typedef struct det_shm_box
+{
+    uint32_t cls;               /* class */
+    float prob;                 /* probability */
+    float x;                    /* center of the box in the DRP-AI input size */
+    float y;
+    float w;                    /* size of the box in the DRP-AI input size */
+    float h;
+} det_shm_box;
+
+/* Result of one frame */
+typedef struct det_shm_frame
+{
+    uint64_t frame_id;          /* capture frame ID of the input image */
+    uint64_t frame_no;          /* inference count */
+    int64_t capture_time;       /* capture time of the input image [ns] (CLOCK_REALTIME) */
+    int64_t publish_time;       /* time of the publication [ns] (CLOCK_REALTIME) */
+    uint32_t num_box;           /* boxes in boxes[] */
+    uint32_t num_detection;     /* detections of the frame (more than num_box if truncated) */
+    det_shm_box boxes[DET_SHM_MAX_BOX];
+} det_shm_frame;
+
+typedef struct alignas(DET_SHM_ALIGN) det_shm_record
+{
+    std::atomic<uint32_t> seq;  /* odd while the writer updates the record */
+    uint32_t reserved;
+    det_shm_frame frame;
+} det_shm_record;
+
+typedef struct alignas(DET_SHM_ALIGN) det_shm_header
+{
+    char magic[8];              /* DET_SHM_MAGIC, written last when the memory is ready */
+    uint32_t version;           /* DET_SHM_VERSION */
+    uint32_t slot_num;          /* number of the records */
+    uint32_t max_box;           /* DET_SHM_MAX_BOX */
+    uint32_t record_size;       /* sizeof(det_shm_record) */
+    std::atomic<int32_t> writer_pid;    /* process ID of the application, 0 after it terminates */
+    uint32_t reserved;
+    std::atomic<uint64_t> num_published;    /* number of the published frames */
+} det_shm_header;
+
+/* Writer of the detection shared memory (single writer). */
+class DetPublisher
+{
+    public:
+        DetPublisher();
+        ~DetPublisher();
+
+        int8_t open(const std::string& shm_name, uint32_t num_slot);
+        void close();
+        det_shm_frame* begin();
+        void commit();
+
+    private:
+        std::string name;
+        uint8_t* map_addr;
+        uint64_t map_size;
+        det_shm_header* header;
+        det_shm_record* records;
+        /* Record being written by begin() and commit() */
+        det_shm_record* current;
+};
+
+/* Reader of the detection shared memory. Any number of processes can read at the same time. */
+class DetSubscriber
+{
+    public:
+        DetSubscriber();
+        ~DetSubscriber();
+
+        int8_t open(const std::string& shm_name);
+        void close();
+        uint64_t get_num_published();
+        int8_t read(uint64_t index, det_shm_frame* frame);
+        int32_t get_writer_pid();
+
+    private:
+        uint8_t* map_addr;
+        uint64_t map_size;
+        const det_shm_header* header;
+        const det_shm_record* records;
+};
+
+#endif
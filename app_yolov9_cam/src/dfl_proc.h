@@ -11,6 +11,19 @@
 #define DFL_PROC_H
 
 #include "define.h"
+#include "worker_pool.h"
+#include "fp16_convert.h"
+#include "tensor_view.h"
+
+/* Detection candidate found by the threshold processing on the class arrays */
+typedef struct dfl_candidate
+{
+    uint8_t scale;      /* index of num_grids[] */
+    uint16_t cell;      /* grid cell in the scale (y * grid + x) */
+    int32_t c;          /* class having the max score */
+    float score;        /* max class score (logit) */
+    float box[4];       /* center x, center y, width, height in model input size */
+} dfl_candidate;
 
 class DFL
 {
@@ -18,20 +31,38 @@ class DFL
         DFL();
         ~DFL();
 
-        void DFL_Proc(float* dfl80, float* dfl40, float* dfl20, float* class80, float* class40, float* class20, float* output_buf);
-        float* split_dfl(float* dfl_arr, int32_t arr_size);
+        int8_t init();
+        void DFL_Proc(const tensor_view* dfl, const tensor_view* cls, float* output_buf);
+        void DFL_Sparse_Proc(const tensor_view* dfl, const tensor_view* cls, std::vector<dfl_candidate>& candidates);
+        void decode_dfl(const float* dfl_arr, int32_t grid, uint32_t grid_offset, int32_t cell_start, int32_t cell_end, float* output_buf);
         double sigmoid(double x);
 
     private:
-        
-        void softmax(const float* input, int size, float* output);
-        float stage_conv(const float* input, int size);
-        float* stage_add_0(float* arr, int32_t h, int32_t w);
-        float* stage_add_1(float* arr, int32_t h, int32_t w);
-        float* stage_sub_0(float* arr, int32_t h, int32_t w);
-        float* stage_sub_1(float* arr, int32_t h, int32_t w);
-        void dfl_process(float* dfl, uint32_t dfl_size, float* dfl_out);
-        void sigmoid_process(float* cls, uint32_t sigmoid_size, float* sigmoid_out);
+        /* Threshold for non-sigmoid value */
+        float th_logit;
+        /* Max class score and class of each grid point */
+        std::vector<float> max_score;
+        std::vector<int32_t> max_class;
+        /* Candidates found in each chunk */
+        std::vector<dfl_candidate> chunk_candidates[CPU_DFL_NUM_CHUNK];
+        /* Input and output arrays of the current frame */
+        const float* dfl_in[NUM_INF_OUT_LAYER];
+        const float* class_in[NUM_INF_OUT_LAYER];
+        float* out_buf;
+        /* Worker threads kept alive from init() */
+        WorkerPool pool;
+        /* Member function run by chunk_job() for the current run_chunks() */
+        void (DFL::*chunk_func)(uint32_t) = NULL;
+
+        template <typename T> float dfl_expectation(const T* input, int32_t step);
+        template <typename T> void decode_cell(const T* dfl_arr, int32_t grid, int32_t cell, float* box);
+        void sigmoid_process(const float* cls, int32_t grid, uint32_t grid_offset, int32_t cell_start, int32_t cell_end, float* output_buf);
+        void scan_class(const float* cls, uint8_t scale, int32_t cell_start, int32_t cell_end, std::vector<dfl_candidate>& candidates);
+        bool chunk_range(uint32_t chunk, int32_t n, int32_t* cell_start, int32_t* cell_end);
+        void dense_chunk(uint32_t chunk);
+        void sparse_chunk(uint32_t chunk);
+        void run_chunks(void (DFL::*f)(uint32_t));
+        static void chunk_job(void* ctx, uint32_t chunk);
 };
 
 #endif
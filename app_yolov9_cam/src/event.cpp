@@ -0,0 +1,160 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : event.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for WongKinYu Detection YOLOv9 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "event.h"
+#include <sys/eventfd.h>
+#include <poll.h>
+
+Event::Event()
+{
+
+}
+
+Event::~Event()
+{
+    close();
+}
+
+/*****************************************
+* Function Name : init
+* Description   : Create the eventfd of the event.
+* Arguments     : -
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t Event::init()
+{
+    close();
+    errno = 0;
+    fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (0 > fd)
+    {
+        fprintf(stderr, "[ERROR] Failed to create eventfd: errno=%d\n", errno);
+        return -1;
+    }
+    return 0;
+}
+
+/*****************************************
+* Function Name : close
+* Description   : Close the eventfd of the event.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void Event::close()
+{
+    if (0 <= fd)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+/*****************************************
+* Function Name : signal
+* Description   : Wake up the thread waiting for the event.
+*                 The signal is kept until the waiting thread wakes up.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void Event::signal()
+{
+    uint64_t one = 1;
+    ssize_t ret = 0;
+
+    if (0 > fd)
+    {
+        return;
+    }
+    do
+    {
+        errno = 0;
+        ret = write(fd, &one, sizeof(one));
+    } while ((0 > ret) && (EINTR == errno));
+    /* EAGAIN: the counter would overflow, i.e. the event is already signaled. */
+    if ((0 > ret) && (EAGAIN != errno))
+    {
+        fprintf(stderr, "[ERROR] Failed to signal event: errno=%d\n", errno);
+    }
+}
+
+/*****************************************
+* Function Name : wait
+* Description   : Sleep until the event or the terminate event is signaled.
+*                 The signal of the event is cleared, that of the terminate event is kept.
+* Arguments     : terminate = terminate event
+*                 timeout = timeout in milliseconds, -1 to wait forever
+* Return value  : EVENT_SIGNALED, EVENT_TERMINATED, EVENT_TIMEOUT or EVENT_ERROR
+******************************************/
+int8_t Event::wait(Event& terminate, int32_t timeout)
+{
+    uint64_t count = 0;
+    ssize_t size = 0;
+    int8_t ret;
+
+    ret = wait_fd(fd, terminate, timeout);
+    if (EVENT_SIGNALED == ret)
+    {
+        do
+        {
+            errno = 0;
+            size = read(fd, &count, sizeof(count));
+        } while ((0 > size) && (EINTR == errno));
+        /* EAGAIN: non-blocking, the signal has been consumed already. */
+        if ((0 > size) && (EAGAIN != errno))
+        {
+            fprintf(stderr, "[ERROR] Failed to clear event: errno=%d\n", errno);
+            ret = EVENT_ERROR;
+        }
+    }
+    return ret;
+}
+
+/*****************************************
+* Function Name : wait_fd
+* Description   : Sleep until the file descriptor is readable or the terminate event is signaled.
+* Arguments     : fd = file descriptor to wait for, -1 to wait only for the terminate event
+*                 terminate = terminate event
+*                 timeout = timeout in milliseconds, -1 to wait forever
+* Return value  : EVENT_SIGNALED, EVENT_TERMINATED, EVENT_TIMEOUT or EVENT_ERROR
+******************************************/
+int8_t Event::wait_fd(int32_t fd, Event& terminate, int32_t timeout)
+{
+    struct pollfd fds[2];
+    int32_t ret;
+
+    /* poll ignores a negative fd. */
+    fds[0].fd = terminate.fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = fd;
+    fds[1].events = POLLIN;
+    do
+    {
+        errno = 0;
+        ret = poll(fds, 2, timeout);
+    } while ((0 > ret) && (EINTR == errno));
+
+    if (0 > ret)
+    {
+        fprintf(stderr, "[ERROR] Failed to wait for event: errno=%d\n", errno);
+        return EVENT_ERROR;
+    }
+    if (0 == ret)
+    {
+        return EVENT_TIMEOUT;
+    }
+    if (0 != (fds[0].revents & POLLIN))
+    {
+        return EVENT_TERMINATED;
+    }
+    return EVENT_SIGNALED;
+}
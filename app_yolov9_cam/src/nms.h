@@ -0,0 +1,54 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : nms.h
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for WongKinYu Detection YOLOv9 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+#ifndef NMS_H
+#define NMS_H
+
+#include "define.h"
+#ifdef POST_PROC_BENCH
+/* Host build of the offline benchmark (bench/) without the box drawing of the application.
+   Same as Box and detection of box.h */
+typedef struct
+{
+    float x, y, w, h;
+} Box;
+
+typedef struct detection
+{
+    Box bbox;
+    int32_t c;
+    float prob;
+} detection;
+#else
+/*box drawing*/
+#include "box.h"
+#endif
+
+class NMS
+{
+    public:
+        NMS();
+        ~NMS();
+
+        void NMS_Proc(std::vector<detection>& det, float th_nms, int32_t width, int32_t height);
+
+    private:
+        /* Kept boxes of the current class in each spatial bin */
+        std::vector<std::vector<uint32_t>> bins;
+        /* Bins used by the current class */
+        std::vector<uint32_t> used_bins;
+        int32_t bin_w;
+        int32_t bin_h;
+        std::vector<detection> kept;
+
+        void bin_range(const Box& b, int32_t* x0, int32_t* y0, int32_t* x1, int32_t* y1);
+        bool is_suppressed(const Box& a, const Box& b, float th_nms);
+};
+
+#endif
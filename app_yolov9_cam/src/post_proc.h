@@ -0,0 +1,54 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : post_proc.h
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for WongKinYu Detection YOLOv9 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+#ifndef POST_PROC_H
+#define POST_PROC_H
+
+#include "define.h"
+#include "tensor_view.h"
+#include "dfl_proc.h"
+#include "nms.h"
+
+/* CPU post-processing chain of DRP-AI output.
+   set_outputs -> dfl_proc -> decode -> nms_proc
+   Used by the application and the offline benchmark (bench/). */
+class PostProc
+{
+    public:
+        PostProc();
+        ~PostProc();
+
+        int8_t init();
+        int8_t set_outputs(const std::tuple<InOutDataType, void*, int64_t>* outputs, int32_t num_output);
+        void dfl_proc();
+        void decode(std::vector<detection>& det_buff);
+        void nms_proc(std::vector<detection>& det_buff);
+        const tensor_view* get_view(int64_t size);
+        uint64_t get_argmax_time();
+
+    private:
+        /* Views of DRP-AI output (80, 40, 20 grids) */
+        tensor_view output_dfl[NUM_INF_OUT_LAYER];
+        tensor_view output_class[NUM_INF_OUT_LAYER];
+        DFL dfl;
+        NMS nms;
+#if (1) == CPU_DFL_SPARSE_DECODE
+        std::vector<dfl_candidate> dfl_candidates;
+#else
+        /* Output of DFL_Proc (4 + NUM_CLASS, num_grid_points) */
+        std::vector<float> drpai_output_buf;
+        /* Max class score and class of each grid point */
+        std::vector<float> max_score;
+        std::vector<int32_t> max_class;
+#endif
+        /* Time of the class argmax in the last decode [ns] */
+        uint64_t argmax_time = 0;
+};
+
+#endif
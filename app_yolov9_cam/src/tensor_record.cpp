@@ -0,0 +1,464 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : tensor_record.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for WongKinYu Detection YOLOv9 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "tensor_record.h"
+#include <algorithm>
+#include <cstddef>
+
+TensorRecordReader::TensorRecordReader()
+{
+    map_addr = NULL;
+    map_size = 0;
+    header = NULL;
+    num_frame = 0;
+}
+
+TensorRecordReader::~TensorRecordReader()
+{
+    close();
+}
+
+/*****************************************
+* Function Name : open
+* Description   : Map the tensor record file.
+*                 The frames not written completely are ignored.
+* Arguments     : path = path of the record file
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t TensorRecordReader::open(const std::string& path)
+{
+    int32_t fd = -1;
+    struct stat st;
+    void* addr = NULL;
+    uint32_t i = 0;
+
+    close();
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (0 > fd)
+    {
+        fprintf(stderr, "[ERROR] Failed to open the tensor record : %s\n", path.c_str());
+        return -1;
+    }
+    if ((0 != fstat(fd, &st)) || ((uint64_t)st.st_size < sizeof(tensor_record_header)))
+    {
+        fprintf(stderr, "[ERROR] Invalid tensor record : %s\n", path.c_str());
+        ::close(fd);
+        return -1;
+    }
+    /* Private mapping: the post-processing may use the outputs as writable buffers */
+    addr = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (MAP_FAILED == addr)
+    {
+        fprintf(stderr, "[ERROR] Failed to map the tensor record : errno=%d\n", errno);
+        return -1;
+    }
+    map_addr = (uint8_t*)addr;
+    map_size = st.st_size;
+    header = (const tensor_record_header*)map_addr;
+
+    if ((0 != memcmp(header->magic, TENSOR_RECORD_MAGIC, sizeof(header->magic)))
+        || (TENSOR_RECORD_VERSION != header->version)
+        || (TENSOR_RECORD_MAX_OUTPUT < header->num_output)
+        || (sizeof(tensor_record_frame) > header->frame_size))
+    {
+        fprintf(stderr, "[ERROR] Invalid tensor record header : %s\n", path.c_str());
+        close();
+        return -1;
+    }
+    for (i = 0; i < header->num_output; i++)
+    {
+        const tensor_record_desc& d = header->desc[i];
+        if (d.offset + d.size * d.elem_size > header->frame_size)
+        {
+            fprintf(stderr, "[ERROR] Invalid tensor record output %u : %s\n", i, path.c_str());
+            close();
+            return -1;
+        }
+    }
+    num_frame = (map_size - sizeof(tensor_record_header)) / header->frame_size;
+    /* The last frame may be allocated but not written when the recording was interrupted. */
+    num_frame = std::min(num_frame, header->num_frame);
+    return 0;
+}
+
+/*****************************************
+* Function Name : close
+* Description   : Unmap the tensor record file.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void TensorRecordReader::close()
+{
+    if (NULL != map_addr)
+    {
+        munmap(map_addr, map_size);
+    }
+    map_addr = NULL;
+    map_size = 0;
+    header = NULL;
+    num_frame = 0;
+}
+
+/*****************************************
+* Function Name : get_num_frame
+* Description   : Get the number of the frames in the record.
+* Arguments     : -
+* Return value  : number of the frames
+******************************************/
+uint64_t TensorRecordReader::get_num_frame()
+{
+    return num_frame;
+}
+
+/*****************************************
+* Function Name : get_num_output
+* Description   : Get the number of the outputs of a frame.
+* Arguments     : -
+* Return value  : number of the outputs
+******************************************/
+uint32_t TensorRecordReader::get_num_output()
+{
+    return (NULL == header) ? 0 : header->num_output;
+}
+
+/*****************************************
+* Function Name : get_frame
+* Description   : Get the frame information.
+* Arguments     : index = frame index in the record
+* Return value  : frame information
+******************************************/
+const tensor_record_frame* TensorRecordReader::get_frame(uint64_t index)
+{
+    return (const tensor_record_frame*)(map_addr + sizeof(tensor_record_header) + index * header->frame_size);
+}
+
+/*****************************************
+* Function Name : get_outputs
+* Description   : Get the outputs of the frame in the same form as runtime.GetOutput(i).
+* Arguments     : index = frame index in the record
+*                 outputs = array of get_num_output() tuples of
+*                           { data type, address of output data, number of elements }
+* Return value  : -
+******************************************/
+void TensorRecordReader::get_outputs(uint64_t index, std::tuple<InOutDataType, void*, int64_t>* outputs)
+{
+    uint8_t* frame = (uint8_t*)get_frame(index);
+
+    for (uint32_t i = 0; i < header->num_output; i++)
+    {
+        const tensor_record_desc& d = header->desc[i];
+        InOutDataType dtype = InOutDataType::OTHER;
+        if (0 == d.dtype)
+        {
+            dtype = InOutDataType::FLOAT32;
+        }
+        else if (1 == d.dtype)
+        {
+            dtype = InOutDataType::FLOAT16;
+        }
+        outputs[i] = std::make_tuple(dtype, (void*)(frame + d.offset), d.size);
+    }
+}
+
+TensorRecorder::TensorRecorder()
+{
+    fd = -1;
+    memset(&header, 0, sizeof(header));
+    max_frame = 0;
+    page_size = 0;
+    num_pushed = 0;
+    num_written = 0;
+    num_dropped.store(0);
+    stop_req = false;
+}
+
+TensorRecorder::~TensorRecorder()
+{
+    close();
+}
+
+/*****************************************
+* Function Name : open
+* Description   : Create the tensor record file and start the writer thread.
+*                 The ring slots are allocated here so that push() does not allocate.
+* Arguments     : path = path of the record file
+*                 outputs = tuples of { data type, address of output data, number of elements }
+*                           as returned by runtime.GetOutput(i)
+*                 num_output = number of outputs
+*                 shapes = shape (N, C, H, W) of each output
+*                 num_slot = number of the ring slots
+*                 frame_limit = max number of frames to be recorded (0: no limit)
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t TensorRecorder::open(const std::string& path, const std::tuple<InOutDataType, void*, int64_t>* outputs,
+    int32_t num_output, const int32_t (*shapes)[4], uint32_t num_slot, uint64_t frame_limit)
+{
+    uint64_t offset = 0;
+    int32_t i = 0;
+
+    close();
+    if ((TENSOR_RECORD_MAX_OUTPUT < num_output) || (0 >= num_output) || (0 == num_slot))
+    {
+        fprintf(stderr, "[ERROR] Invalid tensor record setting : %d outputs, %u slots\n", num_output, num_slot);
+        return -1;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TENSOR_RECORD_MAGIC, sizeof(header.magic));
+    header.version = TENSOR_RECORD_VERSION;
+    header.num_output = num_output;
+    offset = sizeof(tensor_record_frame);
+    for (i = 0; i < num_output; i++)
+    {
+        tensor_record_desc& d = header.desc[i];
+        offset = (offset + TENSOR_RECORD_ALIGN - 1) / TENSOR_RECORD_ALIGN * TENSOR_RECORD_ALIGN;
+        if (InOutDataType::FLOAT32 == std::get<0>(outputs[i]))
+        {
+            d.dtype = 0;
+            d.elem_size = sizeof(float);
+        }
+        else if (InOutDataType::FLOAT16 == std::get<0>(outputs[i]))
+        {
+            d.dtype = 1;
+            d.elem_size = sizeof(uint16_t);
+        }
+        else
+        {
+            fprintf(stderr, "[ERROR] Tensor record : output %d is not floating point.\n", i);
+            return -1;
+        }
+        d.size = std::get<2>(outputs[i]);
+        memcpy(d.shape, shapes[i], sizeof(d.shape));
+        d.offset = offset;
+        offset += d.size * d.elem_size;
+    }
+    header.frame_size = (offset + TENSOR_RECORD_ALIGN - 1) / TENSOR_RECORD_ALIGN * TENSOR_RECORD_ALIGN;
+
+    errno = 0;
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (0 > fd)
+    {
+        fprintf(stderr, "[ERROR] Failed to create the tensor record : %s errno=%d\n", path.c_str(), errno);
+        return -1;
+    }
+    if ((ssize_t)sizeof(header) != pwrite(fd, &header, sizeof(header), 0))
+    {
+        fprintf(stderr, "[ERROR] Failed to write the tensor record header : errno=%d\n", errno);
+        close();
+        return -1;
+    }
+
+    page_size = sysconf(_SC_PAGESIZE);
+    max_frame = frame_limit;
+    ring.resize(num_slot);
+    for (std::vector<uint8_t>& slot : ring)
+    {
+        /* Touch all pages so that push() does not page-fault. */
+        slot.assign(header.frame_size, 0);
+    }
+    num_pushed = 0;
+    num_written = 0;
+    num_dropped.store(0);
+    stop_req = false;
+    try
+    {
+        writer = std::thread(&TensorRecorder::writer_loop, this);
+    }
+    catch (const std::system_error& e)
+    {
+        fprintf(stderr, "[ERROR] Failed to create the tensor record writer thread : %s\n", e.what());
+        close();
+        return -1;
+    }
+    return 0;
+}
+
+/*****************************************
+* Function Name : push
+* Description   : Copy the DRP-AI outputs of the frame to the ring.
+*                 The frame is dropped if the ring is full.
+*                 Nothing is done after max_frame or a write error.
+* Arguments     : info = frame number and timings of the frame
+*                 outputs = tuples of { data type, address of output data, number of elements }
+*                           in the same order as open()
+* Return value  : 0 if the frame is queued
+*                 not 0 if the frame is dropped
+******************************************/
+int8_t TensorRecorder::push(const tensor_record_frame& info, const std::tuple<InOutDataType, void*, int64_t>* outputs)
+{
+    uint64_t index = 0;
+    uint8_t* slot = NULL;
+
+    if (0 > fd)
+    {
+        return -1;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        index = num_pushed;
+        if (stop_req || ((0 != max_frame) && (max_frame <= index)))
+        {
+            return -1;
+        }
+        if (ring.size() <= index - num_written)
+        {
+            num_dropped++;
+            return -1;
+        }
+    }
+
+    /* Only this thread writes the slot until num_pushed is updated. */
+    slot = ring[index % ring.size()].data();
+    memcpy(slot, &info, sizeof(info));
+    for (uint32_t i = 0; i < header.num_output; i++)
+    {
+        const tensor_record_desc& d = header.desc[i];
+        memcpy(slot + d.offset, std::get<1>(outputs[i]), d.size * d.elem_size);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        num_pushed++;
+    }
+    cv.notify_one();
+    return 0;
+}
+
+/*****************************************
+* Function Name : writer_loop
+* Description   : Append the pushed frames to the file until close() is requested.
+*                 The frames already pushed are written before the thread ends.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void TensorRecorder::writer_loop()
+{
+    uint64_t index = 0;
+    int8_t ret = 0;
+
+    while (1)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [this] { return (num_written < num_pushed) || stop_req; });
+            if (num_written == num_pushed)
+            {
+                break;
+            }
+            index = num_written;
+        }
+
+        ret = append(ring[index % ring.size()].data(), index);
+
+        std::lock_guard<std::mutex> lock(mtx);
+        if (0 != ret)
+        {
+            /* Stop recording. The frames written so far are kept. */
+            stop_req = true;
+            break;
+        }
+        num_written++;
+    }
+}
+
+/*****************************************
+* Function Name : append
+* Description   : Extend the file by one frame, copy the frame through mmap
+*                 and update header.num_frame.
+* Arguments     : frame = frame data of header.frame_size bytes
+*                 index = frame index in the record
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t TensorRecorder::append(const uint8_t* frame, uint64_t index)
+{
+    uint64_t offset = sizeof(tensor_record_header) + index * header.frame_size;
+    /* mmap offset must be aligned to the page size */
+    uint64_t map_offset = offset / page_size * page_size;
+    uint64_t map_size = offset - map_offset + header.frame_size;
+    uint64_t num_frame = index + 1;
+    void* addr = NULL;
+
+    errno = 0;
+    if (0 != ftruncate(fd, offset + header.frame_size))
+    {
+        fprintf(stderr, "[ERROR] Failed to extend the tensor record : errno=%d\n", errno);
+        return -1;
+    }
+    addr = mmap(NULL, map_size, PROT_WRITE, MAP_SHARED, fd, map_offset);
+    if (MAP_FAILED == addr)
+    {
+        fprintf(stderr, "[ERROR] Failed to map the tensor record : errno=%d\n", errno);
+        return -1;
+    }
+    memcpy((uint8_t*)addr + (offset - map_offset), frame, header.frame_size);
+    munmap(addr, map_size);
+
+    if ((ssize_t)sizeof(num_frame) != pwrite(fd, &num_frame, sizeof(num_frame), offsetof(tensor_record_header, num_frame)))
+    {
+        fprintf(stderr, "[ERROR] Failed to update the tensor record header : errno=%d\n", errno);
+        return -1;
+    }
+    return 0;
+}
+
+/*****************************************
+* Function Name : close
+* Description   : Write the pushed frames, stop the writer thread and close the file.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void TensorRecorder::close()
+{
+    if (writer.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stop_req = true;
+        }
+        cv.notify_one();
+        writer.join();
+    }
+    if (0 <= fd)
+    {
+        ::close(fd);
+    }
+    fd = -1;
+    ring.clear();
+    ring.shrink_to_fit();
+}
+
+/*****************************************
+* Function Name : get_num_written
+* Description   : Get the number of frames written to the file.
+* Arguments     : -
+* Return value  : number of the frames
+******************************************/
+uint64_t TensorRecorder::get_num_written()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return num_written;
+}
+
+/*****************************************
+* Function Name : get_num_dropped
+* Description   : Get the number of frames dropped because the ring was full.
+* Arguments     : -
+* Return value  : number of the frames
+******************************************/
+uint64_t TensorRecorder::get_num_dropped()
+{
+    return num_dropped.load();
+}
@@ -0,0 +1,123 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : tensor_record.h
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for WongKinYu Detection YOLOv9 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+#ifndef TENSOR_RECORD_H
+#define TENSOR_RECORD_H
+
+#include "define.h"
+#include "tensor_view.h"
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/*****************************************
+* Tensor record file
+*  [tensor_record_header]
+*  [frame 0] [frame 1] ...
+*  Each frame is header.frame_size bytes:
+*  [tensor_record_frame] [output 0] [output 1] ... (each output starts at desc[i].offset of the frame)
+*  The outputs are stored in the order of runtime.GetOutput(i) with the same data type.
+*  The file is append-only. header.num_frame is updated after each frame is written completely.
+******************************************/
+#define TENSOR_RECORD_MAGIC         "DRPAIREC"
+#define TENSOR_RECORD_VERSION       (1)
+/* Max number of the outputs in a record file */
+#define TENSOR_RECORD_MAX_OUTPUT    (16)
+/* Alignment of the outputs in a frame */
+#define TENSOR_RECORD_ALIGN         (64)
+
+/* Description of one output */
+typedef struct tensor_record_desc
+{
+    uint32_t dtype;             /* 0: FLOAT32, 1: FLOAT16 */
+    uint32_t elem_size;         /* bytes of one element */
+    int64_t size;               /* number of elements */
+    int32_t shape[4];           /* N, C, H, W */
+    uint64_t offset;            /* offset of the output from the top of the frame */
+} tensor_record_desc;
+
+typedef struct tensor_record_header
+{
+    char magic[8];              /* TENSOR_RECORD_MAGIC */
+    uint32_t version;           /* TENSOR_RECORD_VERSION */
+    uint32_t num_output;        /* number of outputs */
+    uint64_t frame_size;        /* bytes of one frame */
+    uint64_t num_frame;         /* number of frames written completely */
+    tensor_record_desc desc[TENSOR_RECORD_MAX_OUTPUT];
+} tensor_record_header;
+
+typedef struct tensor_record_frame
+{
+    uint64_t frame_no;          /* inference count */
+    int64_t capture_time;       /* capture time of the input image [ns] (CLOCK_REALTIME) */
+    float pre_time;             /* pre-processing time [ms] */
+    float inf_time;             /* inference time [ms] */
+    float post_time;            /* post-processing time [ms] */
+    uint32_t reserved;
+} tensor_record_frame;
+
+class TensorRecordReader
+{
+    public:
+        TensorRecordReader();
+        ~TensorRecordReader();
+
+        int8_t open(const std::string& path);
+        void close();
+        uint64_t get_num_frame();
+        uint32_t get_num_output();
+        const tensor_record_frame* get_frame(uint64_t index);
+        void get_outputs(uint64_t index, std::tuple<InOutDataType, void*, int64_t>* outputs);
+
+    private:
+        uint8_t* map_addr;
+        uint64_t map_size;
+        const tensor_record_header* header;
+        uint64_t num_frame;
+};
+
+/* Appends the DRP-AI outputs of each frame to the tensor record file.
+   push() copies the outputs to a ring slot on the caller thread and
+   the writer thread appends the slots to the file through mmap. */
+class TensorRecorder
+{
+    public:
+        TensorRecorder();
+        ~TensorRecorder();
+
+        int8_t open(const std::string& path, const std::tuple<InOutDataType, void*, int64_t>* outputs,
+            int32_t num_output, const int32_t (*shapes)[4], uint32_t num_slot, uint64_t frame_limit);
+        int8_t push(const tensor_record_frame& info, const std::tuple<InOutDataType, void*, int64_t>* outputs);
+        void close();
+        uint64_t get_num_written();
+        uint64_t get_num_dropped();
+
+    private:
+        int32_t fd;
+        tensor_record_header header;
+        uint64_t max_frame;
+        uint64_t page_size;
+        /* Frames copied by push(). Slot (n % ring.size()) holds the n-th pushed frame. */
+        std::vector<std::vector<uint8_t>> ring;
+        /* Number of pushed and written frames and the stop request. Guarded by mtx. */
+        uint64_t num_pushed;
+        uint64_t num_written;
+        bool stop_req;
+        std::atomic<uint64_t> num_dropped;
+        std::mutex mtx;
+        /* Notifies the writer thread that a frame is pushed or stop is requested */
+        std::condition_variable cv;
+        std::thread writer;
+
+        void writer_loop();
+        int8_t append(const uint8_t* frame, uint64_t index);
+};
+
+#endif
@@ -0,0 +1,72 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : tensor_view.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for WongKinYu Detection YOLOv9 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "tensor_view.h"
+#include "fp16_convert.h"
+
+/*****************************************
+* Function Name : bind_tensor_view
+* Description   : Set the DRP-AI output to the tensor view.
+*                 The FP32 output is read in place. The FP16 output is converted
+*                 into the staging buffer only when need_fp32 is true.
+* Arguments     : view = tensor view to be set
+*                 output = tuple of { data type, address of output data, number of elements }
+*                          returned by MeraDrpRuntimeWrapper::GetOutput
+*                 c, h, w = shape of the output
+*                 need_fp32 = true if the post-processing reads view.fp32
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t bind_tensor_view(tensor_view& view, const std::tuple<InOutDataType, void*, int64_t>& output,
+                        int32_t c, int32_t h, int32_t w, bool need_fp32)
+{
+    view.dtype = std::get<0>(output);
+    view.data = std::get<1>(output);
+    view.size = std::get<2>(output);
+    view.shape[0] = 1;
+    view.shape[1] = c;
+    view.shape[2] = h;
+    view.shape[3] = w;
+    view.strides[3] = 1;
+    view.strides[2] = w;
+    view.strides[1] = (int64_t)h * w;
+    view.strides[0] = (int64_t)c * h * w;
+    view.scale = (float)MODEL_IN_W / (float)w;
+    view.fp32 = NULL;
+
+    if (view.size != view.strides[0])
+    {
+        fprintf(stderr, "[ERROR] Output size mismatch : %ld (expected %ld).\n", (long)view.size, (long)view.strides[0]);
+        return -1;
+    }
+
+    if (InOutDataType::FLOAT32 == view.dtype)
+    {
+        /* Zero copy */
+        view.fp32 = reinterpret_cast<const float*>(view.data);
+    }
+    else if (InOutDataType::FLOAT16 == view.dtype)
+    {
+        if (need_fp32)
+        {
+            view.staging.resize(view.size);
+            float16_to_float32_array(reinterpret_cast<const uint16_t*>(view.data), view.staging.data(), view.size);
+            view.fp32 = view.staging.data();
+        }
+    }
+    else
+    {
+        fprintf(stderr, "[ERROR] Output data type : not floating point.\n");
+        return -1;
+    }
+    return 0;
+}
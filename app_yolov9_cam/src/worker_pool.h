@@ -0,0 +1,55 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : worker_pool.h
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for WongKinYu Detection YOLOv9 with MIPI/USB Camera
+***********************************************************************************************************************/
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include "define.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/* Function to process one chunk. ctx is the context given to WorkerPool::run(). */
+typedef void (*worker_job_t)(void* ctx, uint32_t chunk);
+
+class WorkerPool
+{
+    public:
+        WorkerPool();
+        ~WorkerPool();
+
+        int8_t start(uint32_t num_worker, const int32_t* cores);
+        void stop();
+        void run(worker_job_t job, void* ctx, uint32_t num_chunk);
+        uint32_t get_num_worker();
+
+    private:
+        std::vector<std::thread> workers;
+        std::mutex mtx;
+        /* Notifies the workers that a new job is set */
+        std::condition_variable cv_start;
+        /* Notifies run() that the workers finished the chunks */
+        std::condition_variable cv_done;
+
+        /* Job of the current frame. Guarded by mtx. */
+        worker_job_t job = NULL;
+        void* job_ctx = NULL;
+        uint32_t num_chunk = 0;
+        uint32_t done_chunk = 0;
+        uint64_t generation = 0;
+        uint32_t busy = 0;
+        bool stop_req = false;
+        /* Next chunk to be taken by the workers or the caller of run() */
+        std::atomic<uint32_t> next_chunk;
+
+        void worker_loop();
+        uint32_t process_chunks(worker_job_t f, void* ctx, uint32_t num);
+};
+
+#endif
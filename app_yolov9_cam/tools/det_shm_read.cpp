@@ -0,0 +1,106 @@
+/***********************************************************************************************************************
+* Copyright (C) 2023 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : det_shm_read.cpp
+* Version      : 2.5.0
+* Description  : RZ/V2H DRP-AI Sample Application for WongKinYu Detection YOLOv9 with MIPI/USB Camera
+*                Example reader of the detection shared memory published with DET_SHM_MODE.
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include <string>
+#include "define.h"
+#include "define_color_yolov9.h"
+#include "det_shm.h"
+
+using namespace std;
+
+/* Wait time when no new frame is published (us) */
+#define POLL_INTERVAL               (1000)
+
+/*****************************************
+* Function Name : get_label
+* Description   : Get the label of the class.
+* Arguments     : cls = class
+* Return value  : label
+******************************************/
+static const char* get_label(uint32_t cls)
+{
+    return (cls < label_file_map.size()) ? label_file_map[cls].c_str() : "unknown";
+}
+
+/*****************************************
+* Function Name : print_frame
+* Description   : Print the detections of the frame and the time from the capture to the publication.
+* Arguments     : frame = published frame
+* Return value  : -
+******************************************/
+static void print_frame(const det_shm_frame* frame)
+{
+    uint32_t i = 0;
+
+    printf("Inference No. %lu (Frame ID %lu) : %u boxes, %.1f [ms] from the capture\n",
+        (unsigned long)(frame->frame_no + 1), (unsigned long)frame->frame_id, frame->num_detection,
+        (frame->publish_time - frame->capture_time) / 1000000.0);
+    for (i = 0; i < frame->num_box; i++)
+    {
+        const det_shm_box* b = &frame->boxes[i];
+        printf(" %-16s %5.1f %% (X, Y, W, H) = (%d, %d, %d, %d)\n",
+            get_label(b->cls), b->prob * 100, (int)b->x, (int)b->y, (int)b->w, (int)b->h);
+    }
+}
+
+/*****************************************
+* Function Name : main
+* Description   : Print the frames published to the detection shared memory until the application terminates.
+* Arguments     : argc = number of arguments
+*                 argv[1] = name of the shared memory (DET_SHM_NAME if omitted)
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int32_t main(int32_t argc, char* argv[])
+{
+    string shm_name = (1 < argc) ? argv[1] : DET_SHM_NAME;
+    DetSubscriber subscriber;
+    det_shm_frame frame;
+    uint64_t next = 0;
+    uint64_t num_published = 0;
+    uint64_t num_missed = 0;
+
+    if (0 != subscriber.open(shm_name))
+    {
+        return -1;
+    }
+    /* Start from the newest frame. */
+    num_published = subscriber.get_num_published();
+    next = (0 < num_published) ? num_published - 1 : 0;
+    while (1)
+    {
+        num_published = subscriber.get_num_published();
+        if (next >= num_published)
+        {
+            if (0 == subscriber.get_writer_pid())
+            {
+                break;
+            }
+            usleep(POLL_INTERVAL);
+            continue;
+        }
+        if (0 == subscriber.read(next, &frame))
+        {
+            print_frame(&frame);
+        }
+        else
+        {
+            /* Overwritten before it was read. */
+            num_missed++;
+        }
+        next++;
+    }
+    fprintf(stderr, "%lu frames published, %lu frames missed\n",
+        (unsigned long)num_published, (unsigned long)num_missed);
+    return 0;
+}